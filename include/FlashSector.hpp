@@ -0,0 +1,22 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+// A sector of the internal flash, used as non-volatile storage.
+// The sector must be reserved in the linker script, so that no code or data is placed into it.
+class FlashSector {
+public:
+    FlashSector(const uint32_t sector, const uint32_t address, const uint32_t size);
+
+    bool read(const uint32_t offset, void * const data, const uint32_t size) const;
+
+    // Erases the whole sector - blocks until the erase is finished, which takes up to a few hundred milliseconds.
+    bool erase();
+
+    bool write(const uint32_t offset, const void * const data, const uint32_t size);
+
+private:
+    const uint32_t sector_;
+    const uint32_t address_;
+    const uint32_t size_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <micro/utils/units.hpp>
+
+#include <SensorData.hpp>
+
+enum class frameStage_t : uint8_t {
+    LinePos,
+    LineFilter,
+    LinePattern,
+    Send,
+    NUM_STAGES
+};
+
+// Follows the frames through the processing stages.
+// Stage times are measured from the start of the scan, so the time of the last stage is the whole sensor-to-CAN latency.
+// The times are stamped with the microsecond counter of the frames and differenced as unsigned values,
+// the float system time would lose precision over the uptime.
+class FrameStats {
+public:
+    static constexpr uint8_t NUM_STAGES = static_cast<uint8_t>(frameStage_t::NUM_STAGES);
+
+    FrameStats();
+
+    // Starts processing of a frame - dropped frames are detected from the gaps in the sequence numbers.
+    // @param tick Microsecond counter value
+    void begin(const Frame& frame, const uint32_t tick);
+
+    // Marks the end of a processing stage of the current frame.
+    // @param tick Microsecond counter value
+    void stamp(const frameStage_t stage, const uint32_t tick);
+
+    uint32_t numFrames() const {
+        return this->numFrames_;
+    }
+
+    uint32_t numDropped() const {
+        return this->numDropped_;
+    }
+
+    // Duration of the scan of the current frame.
+    micro::microsecond_t scanTime() const {
+        return toTime(this->scanEndTick_ - this->scanStartTick_);
+    }
+
+    // Time from the end of the scan until the processing of the current frame has started.
+    micro::microsecond_t waitTime() const {
+        return toTime(this->processStartTick_ - this->scanEndTick_);
+    }
+
+    // Time from the start of the scan until the end of the given stage of the current frame.
+    micro::microsecond_t stageTime(const frameStage_t stage) const {
+        return toTime(this->stageTimes_[static_cast<uint8_t>(stage)]);
+    }
+
+    // Time from the start of the scan until the end of the last stage of the current frame.
+    micro::microsecond_t latency() const {
+        return this->stageTime(frameStage_t::Send);
+    }
+
+    micro::microsecond_t maxLatency() const {
+        return toTime(this->maxLatency_);
+    }
+
+private:
+    static micro::microsecond_t toTime(const uint32_t duration) {
+        return micro::microsecond_t(static_cast<float>(duration));
+    }
+
+    uint32_t numFrames_;
+    uint32_t numDropped_;
+    uint32_t lastSeq_;
+    uint32_t scanStartTick_;
+    uint32_t scanEndTick_;
+    uint32_t processStartTick_;
+    uint32_t stageTimes_[NUM_STAGES]; // [us]
+    uint32_t maxLatency_;             // [us]
+};
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <micro/container/infinite_buffer.hpp>
 #include <micro/container/vec.hpp>
 #include <micro/math/unit_utils.hpp>
 #include <micro/utils/Line.hpp>
@@ -8,45 +7,239 @@
 #include <cfg_sensor.hpp>
 #include <LinePosCalculator.hpp>
 
+#include <limits>
+
 #define TRACKED_LINE_ID_INVALID 0
 #define TRACKED_LINE_ID_MAX     7
 
+enum class lineTrackEvent_t : uint8_t {
+    None,      // no change, used for the periodic states of the lines
+    Born,      // the line has been detected for the first time, it is not validated yet
+    Validated, // the line has been detected over the validation distance, it is in the tracked lines from now on
+    Lost       // the line has been missed over the removal distance, and has been removed
+};
+
+// State and quality of a filtered line, including the lines that are not validated yet.
+struct LineTrack {
+    uint8_t id = 0;
+    micro::millimeter_t pos;
+    float slope = 0.0f;          // lateral position change per mm travelled, multiplied by the speed it is the lateral velocity
+    uint16_t age = 0;            // number of frames the line has been tracked in, 1 in the frame of its birth, saturated
+    uint8_t numMissedFrames = 0; // number of consecutive frames the line has been missed in, its position is only predicted in these frames
+    float confidence = 0.0f;     // detection probability averaged over the validation distance, the misses count as 0
+    bool isValidated = false;
+};
+
+struct LineTrackEvent {
+    lineTrackEvent_t type;
+    LineTrack track; // a lost line is reported with its state from the previous frame
+};
+
+typedef micro::vec<LineTrack, cfg::MAX_NUM_FILTERED_LINES> LineTracks;
+
+// when the most likely hypothesis switches, every previous line can be lost, and every line of the new hypothesis can be born and validated in the same frame
+typedef micro::vec<LineTrackEvent, 3 * cfg::MAX_NUM_FILTERED_LINES> LineTrackEvents;
+
 class LineFilter {
 public:
-    micro::Lines update(const LinePositions& detectedLines);
+    // Updates the tracked lines with the detected lines of a frame.
+    // The lines are predicted by the distance travelled since the previous frame (negative when reversing),
+    // so the tracking does not depend on the frame rate.
+    micro::Lines update(const LinePositions& detectedLines, const micro::millimeter_t distance);
 
-private:
-    typedef micro::infinite_buffer<micro::millimeter_t, 100> linePosSamples_t;
+    // In multi-hypothesis mode the alternative associations of the detected lines are kept until the detections decide between them,
+    // e.g. when two lines converge in a junction, are detected as one, and diverge again. The lines of the most likely hypothesis are returned.
+    void setMultiHypothesisEnabled(const bool enabled);
+
+    // Gets all filtered lines of the last update with their quality, not only the validated ones.
+    const LineTracks& tracks() const {
+        return this->tracks_;
+    }
+
+    // Gets the births, validations and losses of the lines in the last update,
+    // so that the consumers can react to a new line before it appears in the tracked lines.
+    const LineTrackEvents& events() const {
+        return this->events_;
+    }
 
+    // Gets the number of hypotheses kept after the last update - 1 in single-hypothesis mode.
+    uint8_t numHypotheses() const {
+        return this->isMultiHypothesisEnabled_ ? this->hypotheses_.size() : 1;
+    }
+
+    // Gets the maximum number of association search steps of a hypothesis in the last update, the work of the update is proportional to it.
+    uint16_t maxSearchSteps() const {
+        return this->hypothesisGenerator_.maxNumSteps();
+    }
+
+private:
+    // Constant-slope Kalman filter of the lateral position of a line, the step is the distance travelled between the frames.
+    // The covariance is symmetric, only its upper triangle is stored.
     struct filteredLine_t {
+        static constexpr float MEASUREMENT_VAR = cfg::LINE_TRACK_MEASUREMENT_NOISE * cfg::LINE_TRACK_MEASUREMENT_NOISE;
+
         uint8_t id = 0;
-        linePosSamples_t samples;
-        micro::millimeter_t estimated;
-        int8_t cntr = 0;
+        micro::millimeter_t pos;  // estimated position
+        float slope    = 0.0f;    // estimated lateral position change per mm travelled
+        float posVar   = 0.0f;    // variance of the position, in mm^2
+        float covar    = 0.0f;    // covariance of the position and the slope, in mm
+        float slopeVar = 0.0f;    // variance of the slope
+        uint16_t age = 0;                     // number of frames the line has been filtered in
+        uint8_t numDetectedFrames = 0;        // number of consecutive frames the line has been detected in
+        uint8_t numMissedFrames   = 0;        // number of consecutive frames the line has been missed in
+        micro::millimeter_t detectedDistance; // distance travelled while the line has been detected, weighted by the detection probabilities
+        micro::millimeter_t missedDistance;   // distance travelled while the line has been missed
+        float confidence = 0.0f;              // moving average of the detection probabilities over the travelled distance
         bool isValidated = false;
 
-        micro::millimeter_t current() const;
+        bool operator<(const filteredLine_t& other) const { return this->pos < other.pos; }
+        bool operator>(const filteredLine_t& other) const { return this->pos > other.pos; }
+
+        // Starts the track at the detected position, with an unknown slope.
+        void initialize(const micro::millimeter_t measured);
+
+        // Moves the track to the expected position after the given distance.
+        void predict(const micro::millimeter_t distance);
 
-        const micro::millimeter_t& current_raw() const { return this->samples.peek_back(0); }
-        micro::millimeter_t& current_raw() { return this->samples.peek_back(0); }
+        // Gets the variance of the difference of a detected line from the predicted position, in mm^2.
+        float innovationVar(const float measurementVar = MEASUREMENT_VAR) const { return this->posVar + measurementVar; }
+
+        // Corrects the predicted state with the detected position.
+        void correct(const micro::millimeter_t measured, const float measurementVar = MEASUREMENT_VAR);
+
+        // The validation and the removal are based on the travelled distance, so that they take the same length of track at any speed.
+        // Strong detections validate the line sooner, and the frame limits keep the hysteresis at very high speed and at standstill.
+        void onDetected(const micro::millimeter_t distance, const float probability) {
+            this->age               = micro::min<uint32_t>(this->age + 1, std::numeric_limits<uint16_t>::max());
+            this->confidence       += (probability - this->confidence) * confidenceWeight(distance);
+            this->numMissedFrames   = 0;
+            this->missedDistance    = micro::millimeter_t(0);
+            this->numDetectedFrames = micro::min<uint8_t>(this->numDetectedFrames + 1, cfg::LINE_FILTER_MAX_FRAMES);
+            this->detectedDistance += micro::abs(distance) * probability;
+        }
+
+        void onMissed(const micro::millimeter_t distance) {
+            this->age               = micro::min<uint32_t>(this->age + 1, std::numeric_limits<uint16_t>::max());
+            this->confidence       -= this->confidence * confidenceWeight(distance);
+            this->numDetectedFrames = 0;
+            this->detectedDistance  = micro::millimeter_t(0);
+            this->numMissedFrames   = micro::min<uint8_t>(this->numMissedFrames + 1, cfg::LINE_FILTER_MAX_FRAMES);
+            this->missedDistance   += micro::abs(distance);
+        }
 
-        bool operator<(const filteredLine_t& other) const { return this->current_raw() < other.current_raw(); }
-        bool operator>(const filteredLine_t& other) const { return this->current_raw() > other.current_raw(); }
+        bool isConfirmed() const {
+            return this->numDetectedFrames >= cfg::LINE_FILTER_MIN_FRAMES &&
+                (this->detectedDistance >= cfg::LINE_VALIDATION_DISTANCE || this->numDetectedFrames == cfg::LINE_FILTER_MAX_FRAMES);
+        }
 
-        void increaseCntr() {
-            cntr = micro::max<int8_t>(cntr, 0);
-            cntr = micro::min<int8_t>(cntr + 1, cfg::LINE_FILTER_HYSTERESIS);
+        bool isLost() const {
+            return this->numMissedFrames >= cfg::LINE_FILTER_MIN_FRAMES &&
+                (this->missedDistance >= cfg::LINE_REMOVAL_DISTANCE || this->numMissedFrames == cfg::LINE_FILTER_MAX_FRAMES);
         }
 
-        void decreaseCntr() {
-            cntr = micro::min<int8_t>(cntr, 0);
-            cntr = micro::max<int8_t>(cntr - 1, -cfg::LINE_FILTER_HYSTERESIS);
+        // The confidence is averaged over the validation distance, or over the maximum number of frames at standstill.
+        static float confidenceWeight(const micro::millimeter_t distance) {
+            return micro::min(micro::max(micro::abs(distance).get() / cfg::LINE_VALIDATION_DISTANCE.get(), 1.0f / cfg::LINE_FILTER_MAX_FRAMES), 1.0f);
         }
     };
 
     typedef micro::sorted_vec<filteredLine_t, cfg::MAX_NUM_FILTERED_LINES> filteredLines_t;
 
-    uint8_t generateNewLineId();
+    // the detected line of each filtered line, or -1 if the filtered line has not been detected
+    typedef int8_t association_t[cfg::MAX_NUM_FILTERED_LINES];
+
+    struct hypothesis_t {
+        filteredLines_t lines;
+        float cost = 0.0f; // negative log-likelihood of the associations, relative to the most likely hypothesis
+    };
+
+    typedef micro::vec<hypothesis_t, cfg::LINE_FILTER_MAX_HYPOTHESES> hypotheses_t;
+
+    // Finds the most likely associations of the detected lines to the filtered lines of all hypotheses.
+    // The cost of an association is its negative log-likelihood, in the units of the squared normalized innovations:
+    // the pairs cost their normalized innovations, the missed lines and the new lines cost constants, and weak detections cost more.
+    // Unlike in the single-hypothesis assignment, two filtered lines may share a detection, which is the merged image of the lines
+    // when they cross each other in a junction, so none of them needs to be dropped before they diverge again.
+    // The choices of each filtered line are tried from the cheapest one, and the branches that cannot beat the worst of the best associations
+    // found so far, even with the cheapest choices for the rest of the lines, are cut. The number of search steps is limited,
+    // the cheapest associations are found within the first steps, and every branch ends in a valid association.
+    class HypothesisGenerator {
+    public:
+        struct costs_t {
+            float pair[cfg::MAX_NUM_FILTERED_LINES][micro::Line::MAX_NUM_LINES];        // cost of a filtered line taking a detected line alone, or NO_PAIR
+            float merged[cfg::MAX_NUM_FILTERED_LINES][micro::Line::MAX_NUM_LINES];      // cost of the first filtered line of a merged image, or NO_PAIR
+            float mergedExtra[cfg::MAX_NUM_FILTERED_LINES][micro::Line::MAX_NUM_LINES]; // cost of the second filtered line of a merged image, or NO_PAIR
+            float newLine[micro::Line::MAX_NUM_LINES];                                   // cost of a new line at a detected line without filtered lines
+            uint8_t numFiltered = 0;
+            uint8_t numDetected = 0;
+        };
+
+        struct candidate_t {
+            uint8_t hypothesisIdx = 0;
+            int8_t detectedIdx[cfg::MAX_NUM_FILTERED_LINES]; // the detected line of each filtered line, or UNMATCHED
+            float cost = 0.0f;
+
+            bool operator<(const candidate_t& other) const { return this->cost < other.cost; }
+            bool operator>(const candidate_t& other) const { return this->cost > other.cost; }
+        };
+
+        typedef micro::sorted_vec<candidate_t, cfg::LINE_FILTER_MAX_HYPOTHESES> candidates_t;
+
+        // Drops the associations of the previous frame.
+        void reset();
+
+        // Searches the associations of a hypothesis, keeping the best ones of all the searched hypotheses.
+        void search(const uint8_t hypothesisIdx, const float hypothesisCost, const costs_t& costs);
+
+        const candidates_t& candidates() const { return this->best_; }
+
+        // Gets the maximum number of search steps of a hypothesis since the reset.
+        uint16_t maxNumSteps() const { return this->maxNumSteps_; }
+
+    private:
+        // a detected line a filtered line may take, alone or as the first line of a merged image, or UNMATCHED if the filtered line is missed
+        struct choice_t {
+            int8_t detectedIdx;
+            bool isMerged;
+            float cost; // the costs of both lines of a merged image
+
+            bool operator<(const choice_t& other) const { return this->cost < other.cost; }
+            bool operator>(const choice_t& other) const { return this->cost > other.cost; }
+        };
+
+        typedef micro::sorted_vec<choice_t, 2 * micro::Line::MAX_NUM_LINES + 1> choices_t;
+
+        bool isPruned(const float cost) const;
+        void search(const uint8_t filteredIdx, const float cost, const uint8_t usedDetected, candidate_t& current, int8_t forcedDetectedIdx[]);
+
+        const costs_t *costs_ = nullptr;
+        choices_t choices_[cfg::MAX_NUM_FILTERED_LINES];
+        float minRemainingCosts_[cfg::MAX_NUM_FILTERED_LINES + 1];
+        uint16_t numSteps_    = 0;
+        uint16_t maxNumSteps_ = 0;
+        candidates_t best_; // sorted by cost
+    };
+
+    void updateSingleHypothesis(const LinePositions& detectedLines, const micro::millimeter_t distance);
+    void updateMultiHypothesis(const LinePositions& detectedLines, const micro::millimeter_t distance);
+
+    // Corrects the detected lines, counts the misses, removes the lost lines, validates the confirmed ones, and adds the new lines.
+    // Checks if two hypotheses have the same tracks, so that they would continue the same way.
+    static bool isSameTrackSet(const filteredLines_t& a, const filteredLines_t& b);
+
+    static void applyAssociation(filteredLines_t& lines, const LinePositions& detectedLines, const association_t& association, const micro::millimeter_t distance);
+
+    static uint8_t generateNewLineId(const filteredLines_t& lines);
+
+    // Updates the line tracks from the filtered lines, and finds the events by comparing them to the previous tracks.
+    void updateTracks(const filteredLines_t& lines);
 
     filteredLines_t lines_;
+    bool isMultiHypothesisEnabled_ = false;
+    hypotheses_t hypotheses_;     // sorted by cost, the first one is the most likely
+    hypotheses_t nextHypotheses_; // the hypotheses of the current frame are built here, so that they do not need to fit on the task stack
+    HypothesisGenerator hypothesisGenerator_;           // the association search state does not fit on the task stack either
+    HypothesisGenerator::costs_t hypothesisCosts_;
+    LineTracks tracks_;
+    LineTrackEvents events_;
 };
@@ -6,6 +6,7 @@
 #include <micro/utils/units.hpp>
 
 #include <cfg_sensor.hpp>
+#include <PanelGeometry.hpp>
 #include <SensorData.hpp>
 
 #include <utility>
@@ -20,9 +21,6 @@ struct WeightCalculator {
         , lastWeight(radius - micro::round_down(radius - 0.001f))
         , sumWeight(1.0f + 2 * (this->radius - 1 + this->lastWeight)) {}
 
-    constexpr WeightCalculator(const float radius, const uint8_t centerIdx)
-        : WeightCalculator(radius <= centerIdx ? radius : static_cast<float>(centerIdx)) {}
-
     constexpr float weight(const int8_t subIdx) const {
         return micro::abs(subIdx) == this->radius ? this->lastWeight : 1.0f;
     }
@@ -38,11 +36,84 @@ struct LinePosition {
 
 typedef micro::sorted_vec<LinePosition, micro::Line::MAX_NUM_LINES> LinePositions;
 
-class LinePosCalculator {
+enum class linePosEstimator_t : uint8_t {
+    Centroid,      // weighted average of the intensities around the peak
+    MatchedFilter, // correlation with the intensity profile of a line, interpolated around its maximum
+    PeakFit        // Gaussian fit through the strongest sensor and its neighbors
+};
+
+// Calculates the line positions from the measurements of a panel with the given geometry.
+// The geometry is a compile-time parameter, so that the loops are unrolled with constant bounds and weights.
+// The 32, 48 and 64-sensor variants are instantiated in LinePosCalculator.cpp.
+template <typename Geometry>
+class BasicLinePosCalculator {
 public:
-    explicit LinePosCalculator(const bool whiteLevelCalibrationEnabled);
+    typedef typename Geometry::measurements_t measurements_t;
+    typedef typename Geometry::sensorMask_t sensorMask_t;
+
+    explicit BasicLinePosCalculator(const bool whiteLevelCalibrationEnabled);
+
+    LinePositions calculate(const measurements_t& measurements) {
+        return this->calculate(measurements, sensorMask_t().set());
+    }
+
+    // Calculates the line positions from the active sensors only, the measurements of all other sensors are ignored.
+    // The work is proportional to the number of active sensors, so narrow scan ranges are also cheaper to process.
+    // The white levels are calibrated from full frames only, and adapted only for the active sensors.
+    LinePositions calculate(const measurements_t& measurements, const sensorMask_t& activeSensors);
+
+    // When enabled, the white levels are initialized from the first frame instead of the calibration frames,
+    // and are continuously adapted to the lighting using the sensors that are not covered by a line.
+    void setWhiteLevelAdaptationEnabled(const bool enabled) {
+        this->whiteLevelAdaptationEnabled_ = enabled;
+    }
+
+    bool isCalibrated() const {
+        return !this->whiteLevelCalibrationEnabled_ || this->numCalibrationFrames_ == cfg::WHITE_LEVEL_CALIBRATION_FRAMES;
+    }
+
+    const measurements_t& whiteLevels() const {
+        return this->whiteLevels_;
+    }
+
+    // Sets previously saved white levels instead of the calibration.
+    // The white levels are checked against the next frames, and the calibration is restarted if they do not match the surface.
+    void setWhiteLevels(const measurements_t& whiteLevels);
+
+    bool isCheckingWhiteLevels() const {
+        return this->numCheckFrames_ > 0;
+    }
+
+    // Checks if the white levels have been calibrated since the last save - in adaptive mode the white levels are saved once,
+    // after they have been adapted for the same number of frames as the calibration.
+    bool hasUnsavedWhiteLevels() const {
+        return this->hasUnsavedWhiteLevels_;
+    }
 
-    LinePositions calculate(const Measurements& measurements);
+    void onWhiteLevelsSaved() {
+        this->hasUnsavedWhiteLevels_ = false;
+    }
+
+    // The offset filter removes the ambient light that applies to the neighboring sensors.
+    // It can be disabled when the ambient light has already been removed from the measurements.
+    void setOffsetFilterEnabled(const bool enabled) {
+        this->offsetFilterEnabled_ = enabled;
+    }
+
+    // Sets the sub-sensor estimator of the line positions - takes effect from the next frame.
+    void setEstimator(const linePosEstimator_t estimator) {
+        this->estimator_ = estimator;
+    }
+
+    // Removes the offset that applies to the neighboring sensors - each value is scaled between the 1/3 percentile of its window and 1.
+    // The windows are truncated at the edges of the given number of sensors.
+    static void filterOffset(const float * const scaled, float * const OUT result, const uint8_t size = Geometry::NUM_SENSORS);
+
+    // Gets the scale of the measurements of a sensor with the given white level - rebuilt only when the white levels change.
+    // The normalized measurements are within 2^-23 of micro::map<uint8_t>(value, whiteLevel, 255, 0.0f, 1.0f), see the normalization test.
+    static float whiteLevelScale(const uint8_t whiteLevel) {
+        return whiteLevel < 255 ? 1.0f / (255 - whiteLevel) : 0.0f;
+    }
 
     static micro::millimeter_t optoIdxToLinePos(const float optoIdx);
     static float linePosToOptoPos(const micro::millimeter_t linePos);
@@ -56,20 +127,64 @@ private:
         bool operator>(const groupIntensity_t& other) const { return this->intensity > other.intensity; }
     };
 
-    typedef micro::vec<groupIntensity_t, cfg::NUM_SENSORS - 2 * micro::round_up(cfg::LINE_POS_CALC_INTENSITY_GROUP_RADIUS)> groupIntensities_t;
+    typedef micro::vec<groupIntensity_t, Geometry::NUM_SENSORS - 2 * micro::round_up(Geometry::INTENSITY_GROUP_RADIUS)> groupIntensities_t;
+
+    // the strongest peaks, some of them may still be rejected as too close to a stronger line
+    typedef micro::vec<groupIntensity_t, 2 * micro::Line::MAX_NUM_LINES> peaks_t;
 
-    LinePositions runCalculation(const Measurements& measurements);
+    // the sensors covered by the lines
+    typedef std::array<bool, Geometry::NUM_SENSORS> lineSensors_t;
 
-    void runCalibration(const Measurements& measurements);
+    // the continuous ranges of the active sensors - [first, second)
+    typedef micro::vec<std::pair<uint8_t, uint8_t>, Geometry::NUM_SENSORS / 2> sensorRanges_t;
+
+    LinePositions runCalculation(const measurements_t& measurements, const sensorRanges_t& ranges);
+
+    void runCalibration(const measurements_t& measurements);
 
     void updateInvalidWhiteLevels(const LinePositions& linePositions);
 
-    void normalize(const Measurements& measurements, float * const OUT result);
+    void initProvisionalWhiteLevels(const measurements_t& measurements);
+
+    void checkWhiteLevels(const measurements_t& measurements, const sensorMask_t& activeSensors, const LinePositions& linePositions);
+
+    void resetWhiteLevels();
+
+    void adaptWhiteLevels(const measurements_t& measurements, const sensorMask_t& activeSensors, const LinePositions& linePositions);
 
-    static groupIntensities_t calculateGroupIntensities(const float * const intensities);
-    static micro::millimeter_t calculateLinePos(const float * const intensities, const uint8_t centerIdx);
+    void updateWhiteLevelScales();
+
+    void normalize(const measurements_t& measurements, const sensorRanges_t& ranges, float * const OUT result);
+
+    static sensorRanges_t activeRanges(const sensorMask_t& activeSensors);
+    static groupIntensities_t calculateGroupIntensities(const float * const intensities, const sensorRanges_t& ranges);
+    static peaks_t findPeaks(const groupIntensities_t& groupIntensities);
+    micro::millimeter_t calculateLinePos(const float * const intensities, const uint8_t centerIdx) const;
+
+    static float estimateCentroid(const float * const intensities, const uint8_t centerIdx);
+    static float estimateMatchedFilter(const float * const intensities, const uint8_t centerIdx);
+    static float estimatePeakFit(const float * const intensities, const uint8_t centerIdx);
+    static std::pair<uint8_t, uint8_t> lineSensorRange(const LinePosition& linePos);
+    static lineSensors_t lineSensors(const LinePositions& linePositions);
 
     bool whiteLevelCalibrationEnabled_;
-    Measurements whiteLevels_;
-    micro::vec<Measurements, 200> whiteLevelCalibrationBuffer_;
+    bool offsetFilterEnabled_;
+    linePosEstimator_t estimator_;
+    bool whiteLevelAdaptationEnabled_;
+    measurements_t whiteLevels_;
+    std::array<float, Geometry::NUM_SENSORS> whiteLevelScales_;
+
+    // the white levels are the averages of the calibration frames, only the running sums are stored instead of the frames
+    std::array<uint16_t, Geometry::NUM_SENSORS> whiteLevelSums_;
+    uint8_t numCalibrationFrames_;
+
+    // the adapted white levels are stored with a fractional part, otherwise the small steps would be lost in the rounding
+    std::array<float, Geometry::NUM_SENSORS> whiteLevelEstimates_;
+    uint8_t numAdaptedFrames_;
+
+    uint8_t numCheckFrames_;
+    uint8_t numFailedCheckFrames_;
+    bool hasUnsavedWhiteLevels_;
 };
+
+typedef BasicLinePosCalculator<DefaultPanelGeometry> LinePosCalculator;
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <micro/math/numeric.hpp>
+#include <micro/utils/units.hpp>
+
+#include <LineFilter.hpp>
+
+namespace micro {
+namespace can {
+
+// Compact state and quality of one line track, it fits into a classic 8-byte CAN frame.
+// The events are sent in the frame they happen in, so that the control can react to a new line before it appears in the Lines message,
+// and the states of all tracks are sent round robin with no event.
+// The lateral velocity of the line is its slope multiplied by the speed of the car.
+template <uint16_t ID>
+struct LineTrackFrame {
+    static constexpr uint16_t id() { return ID; }
+    static constexpr micro::millisecond_t period() { return micro::millisecond_t(20); }
+
+    static constexpr float POS_RESOLUTION   = 0.1f;   // [mm]
+    static constexpr float SLOPE_RESOLUTION = 0.001f; // [mm/mm]
+
+    uint8_t idEvent;         // the line ID in bits 0-2, the validated flag in bit 3, the event in bits 4-5
+    int16_t pos;             // [0.1 mm]
+    int16_t slope;           // [0.001 mm/mm]
+    uint8_t age;             // [frames], saturated
+    uint8_t numMissedFrames; // [frames]
+    uint8_t confidence;      // [1/255]
+
+    LineTrackFrame(const LineTrack& track, const lineTrackEvent_t event)
+        : idEvent((track.id & 0x07) | (track.isValidated ? 0x08 : 0x00) | (static_cast<uint8_t>(event) << 4))
+        , pos(static_cast<int16_t>(micro::clamp<int32_t>(micro::round(track.pos.get() / POS_RESOLUTION), INT16_MIN, INT16_MAX)))
+        , slope(static_cast<int16_t>(micro::clamp<int32_t>(micro::round(track.slope / SLOPE_RESOLUTION), INT16_MIN, INT16_MAX)))
+        , age(static_cast<uint8_t>(micro::min<uint16_t>(track.age, UINT8_MAX)))
+        , numMissedFrames(track.numMissedFrames)
+        , confidence(static_cast<uint8_t>(micro::round(micro::clamp(track.confidence, 0.0f, 1.0f) * UINT8_MAX))) {}
+
+    void acquire(LineTrack& OUT track, lineTrackEvent_t& OUT event) const {
+        track.id              = this->idEvent & 0x07;
+        track.isValidated     = !!(this->idEvent & 0x08);
+        track.pos             = micro::millimeter_t(this->pos * POS_RESOLUTION);
+        track.slope           = this->slope * SLOPE_RESOLUTION;
+        track.age             = this->age;
+        track.numMissedFrames = this->numMissedFrames;
+        track.confidence      = static_cast<float>(this->confidence) / UINT8_MAX;
+        event                 = static_cast<lineTrackEvent_t>((this->idEvent >> 4) & 0x03);
+    }
+} __attribute__((packed));
+
+static_assert(sizeof(LineTrackFrame<0>) == 8, "Line track frame must fit into a classic CAN frame");
+static_assert(TRACKED_LINE_ID_MAX <= 0x07, "Line IDs must fit into 3 bits");
+
+// the identifiers are reserved in the vehicle CAN identifier map, see README.md
+typedef LineTrackFrame<0x1a8> FrontLineTrack;
+typedef LineTrackFrame<0x1a9> RearLineTrack;
+
+} // namespace can
+} // namespace micro
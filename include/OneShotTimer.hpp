@@ -0,0 +1,24 @@
+#pragma once
+
+#include <micro/port/timer.hpp>
+#include <micro/utils/units.hpp>
+
+// Microsecond resolution one-shot timer on top of the system timer.
+// The system timer is the HAL time base: a 1 MHz counter that overflows every millisecond.
+// The timeout is signaled by the capture/compare interrupt of the timer, so the CPU is free while waiting.
+// The timer is not part of the host builds - the simulator runs it on the simulated system timer.
+class OneShotTimer {
+public:
+    explicit OneShotTimer(const micro::timer_t& timer);
+
+    // Gets the current time in microseconds - wraps around in ~71 minutes, differences must be calculated as unsigned values.
+    uint32_t now() const;
+
+    // Starts the timer - delay must be shorter than the system timer period (1 millisecond).
+    void start(const micro::microsecond_t delay);
+
+    void stop();
+
+private:
+    const micro::timer_t timer_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+#include <micro/utils/units.hpp>
+
+#include <cfg_sensor.hpp>
+
+#include <array>
+#include <bitset>
+
+// Compile-time description of a sensor panel.
+// Panels of different sizes use the same sensor pitch, ADCs and opto LED drivers, only the number of sensors differs.
+template <uint8_t N>
+struct PanelGeometry {
+    // each ADC reads 8 sensors, and the selector groups alternate between the even and the odd ADCs
+    static_assert(N > 0 && N % 16 == 0, "Number of sensors must be a multiple of 16");
+
+    static constexpr uint8_t NUM_SENSORS                = N;
+    static constexpr uint8_t NUM_ADCS                   = N / 8;
+    static constexpr uint8_t OFFSET_FILTER_RADIUS       = cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS;
+    static constexpr float INTENSITY_GROUP_RADIUS       = cfg::LINE_POS_CALC_INTENSITY_GROUP_RADIUS;
+    static constexpr float GROUP_RADIUS                 = cfg::LINE_POS_CALC_GROUP_RADIUS;
+    static constexpr micro::millimeter_t ARRAY_LENGTH   = cfg::OPTO_ARRAY_LENGTH * ((N - 1.0f) / (cfg::NUM_SENSORS - 1.0f));
+
+    typedef std::array<uint8_t, N> measurements_t;
+    typedef std::bitset<N> sensorMask_t;
+};
+
+template <uint8_t N> constexpr uint8_t PanelGeometry<N>::NUM_SENSORS;
+template <uint8_t N> constexpr uint8_t PanelGeometry<N>::NUM_ADCS;
+template <uint8_t N> constexpr uint8_t PanelGeometry<N>::OFFSET_FILTER_RADIUS;
+template <uint8_t N> constexpr float PanelGeometry<N>::INTENSITY_GROUP_RADIUS;
+template <uint8_t N> constexpr float PanelGeometry<N>::GROUP_RADIUS;
+template <uint8_t N> constexpr micro::millimeter_t PanelGeometry<N>::ARRAY_LENGTH;
+
+// the geometry of the built panel
+typedef PanelGeometry<cfg::NUM_SENSORS> DefaultPanelGeometry;
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <micro/container/vec.hpp>
+
+#include <PanelGeometry.hpp>
+#include <SensorData.hpp>
+
+#include <algorithm>
+
+constexpr uint8_t NUM_SCAN_GROUPS = 16;  // number of opto selector patterns needed to light up all sensors
+constexpr uint8_t NUM_ADCS        = DefaultPanelGeometry::NUM_ADCS;
+constexpr uint8_t ADC_BUFFER_SIZE = 3;
+constexpr uint8_t MAX_ADC_SAMPLES = 4;   // maximum number of conversions per sensor in one frame
+
+// Precomputed SPI/GPIO transaction table of a full sensor frame.
+// The selector patterns are generated at compile time for the panel geometry, the variants are instantiated in ScanSequencer.cpp.
+template <typename Geometry>
+class BasicScanTable {
+public:
+    typedef typename Geometry::sensorMask_t sensorMask_t;
+
+    struct transaction_t {
+        enum type_t : uint8_t {
+            SELECT, // shifts the selector pattern of a group into the opto LED drivers
+            READ    // reads one sensor of the group through its ADC
+        };
+
+        type_t type;
+        uint8_t group;     // selector group - used by SELECT transactions
+        uint8_t adcIdx;    // ADC index      - used by READ transactions
+        uint8_t sensorIdx; // sensor index   - used by READ transactions
+    };
+
+    typedef micro::vec<transaction_t, NUM_SCAN_GROUPS + Geometry::NUM_SENSORS> transactions_t;
+
+    // Builds the table for the given sensors - groups with no sensors to read are skipped entirely.
+    // Each sensor is converted numSamples times in one ADC burst.
+    void build(const sensorMask_t& sensors, const uint8_t numSamples);
+
+    // Builds a table that reads the given sensors with all LEDs off - used for measuring the ambient light.
+    void buildDark(const sensorMask_t& sensors);
+
+    const transactions_t& transactions() const { return this->transactions_; }
+
+    uint8_t numSamples() const { return this->numSamples_; }
+
+    static const uint8_t* selector(const uint8_t group);
+    static const uint8_t* adcControl(const uint8_t sensorIdx);
+    static uint8_t adcValue(const uint8_t * const rxBuffer);
+
+private:
+    transactions_t transactions_;
+    uint8_t numSamples_ = 1;
+};
+
+typedef BasicScanTable<DefaultPanelGeometry> ScanTable;
+
+enum class sampleFilter_t : uint8_t {
+    Mean,  // average of the samples
+    Median // middle sample - rejects single spikes
+};
+
+enum class scanMode_t : uint8_t {
+    Sequential, // LEDs are turned off after each group, the next selector is shifted while all LEDs are off
+    Pipelined   // the next selector is shifted while the current group is still lit, the latch pulse switches directly between the groups
+};
+
+// Executes a scan table back-to-back from the transfer complete and timer callbacks.
+// The bus type must provide the following non-blocking operations:
+//     void exchange(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size); // completion must be reported via onTransferFinished()
+//     void latchOpto();
+//     void enableOpto(const bool enabled);
+//     void selectAdc(const uint8_t adcIdx, const bool selected);
+//     uint32_t now() const;                                                     // current time in microseconds
+//     void startTimer(const micro::microsecond_t delay);                         // timeout must be reported via onTimerElapsed()
+template <typename Bus, typename Geometry = DefaultPanelGeometry>
+class ScanSequencer {
+public:
+    typedef BasicScanTable<Geometry> table_t;
+    typedef typename Geometry::measurements_t measurements_t;
+
+    struct stats_t {
+        uint32_t frames       = 0;
+        uint32_t transactions = 0;
+        uint32_t settleTime   = 0; // [us] time spent waiting for the LEDs to settle - the CPU is free during this period
+    };
+
+    explicit ScanSequencer(Bus& bus)
+        : bus_(bus)
+        , table_(nullptr)
+        , measurements_(nullptr)
+        , idx_(0)
+        , rxBuffer_{}
+        , settleStartTime_(0)
+        , mode_(scanMode_t::Sequential)
+        , sampleFilter_(sampleFilter_t::Mean)
+        , isOptoEnabled_(false) {}
+
+    // Sets the scan mode - takes effect from the next frame.
+    void setMode(const scanMode_t mode) {
+        this->mode_ = mode;
+    }
+
+    // Sets how the samples of an oversampled sensor are combined.
+    void setSampleFilter(const sampleFilter_t filter) {
+        this->sampleFilter_ = filter;
+    }
+
+    const stats_t& stats() const {
+        return this->stats_;
+    }
+
+    bool isBusy() const {
+        return this->table_ != nullptr;
+    }
+
+    void start(const table_t& table, measurements_t& OUT measurements) {
+        if (!table.transactions().empty()) {
+            this->table_        = &table;
+            this->measurements_ = &measurements;
+            this->idx_          = 0;
+            this->startTransaction();
+        }
+    }
+
+    void abort() {
+        this->table_ = nullptr;
+        this->bus_.enableOpto(false);
+        this->isOptoEnabled_ = false;
+    }
+
+    // Called from the transfer complete interrupt.
+    // @returns True if the last transaction of the frame has finished.
+    bool onTransferFinished() {
+        if (!this->isBusy()) {
+            return false;
+        }
+
+        const typename table_t::transaction_t& current = this->table_->transactions()[this->idx_];
+
+        if (table_t::transaction_t::SELECT == current.type) {
+            this->bus_.latchOpto();
+
+            // LEDs are only turned on if there are sensors to read in the group
+            if (this->isNextRead()) {
+                this->setOptoEnabled(true);
+                this->settleStartTime_ = this->bus_.now();
+                this->bus_.startTimer(cfg::OPTO_SETTLE_TIME);
+                return false;
+            }
+
+            this->setOptoEnabled(false);
+        } else {
+            this->bus_.selectAdc(current.adcIdx, false);
+            (*this->measurements_)[current.sensorIdx] = this->combineSamples();
+        }
+
+        return this->next();
+    }
+
+    // Called from the timer interrupt, when the LEDs have settled.
+    // Waiting only happens before READ transactions, therefore the frame never finishes here.
+    void onTimerElapsed() {
+        if (this->isBusy()) {
+            this->stats_.settleTime += this->bus_.now() - this->settleStartTime_;
+            this->next();
+        }
+    }
+
+private:
+    bool isNextRead() const {
+        return this->idx_ + 1 < this->table_->transactions().size() &&
+            table_t::transaction_t::READ == this->table_->transactions()[this->idx_ + 1].type;
+    }
+
+    uint8_t combineSamples() const {
+        const uint8_t numSamples = this->table_->numSamples();
+        uint8_t samples[MAX_ADC_SAMPLES];
+        uint32_t sum = 0;
+
+        for (uint8_t i = 0; i < numSamples; ++i) {
+            samples[i] = table_t::adcValue(&this->rxBuffer_[i * ADC_BUFFER_SIZE]);
+            sum += samples[i];
+        }
+
+        if (sampleFilter_t::Median == this->sampleFilter_ && numSamples > 2) {
+            std::sort(&samples[0], &samples[numSamples]);
+            return numSamples % 2 ? samples[numSamples / 2] : (samples[numSamples / 2 - 1] + samples[numSamples / 2] + 1) / 2;
+        }
+
+        return (sum + numSamples / 2) / numSamples;
+    }
+
+    void setOptoEnabled(const bool enabled) {
+        if (enabled != this->isOptoEnabled_) {
+            this->bus_.enableOpto(enabled);
+            this->isOptoEnabled_ = enabled;
+        }
+    }
+
+    bool next() {
+        const bool isLast = ++this->idx_ == this->table_->transactions().size();
+
+        // in pipelined mode the current group stays lit while the next selector is being shifted,
+        // the new pattern only goes live when it is latched
+        if (isLast || (scanMode_t::Sequential == this->mode_ && table_t::transaction_t::SELECT == this->table_->transactions()[this->idx_].type)) {
+            this->setOptoEnabled(false);
+        }
+
+        if (isLast) {
+            this->table_ = nullptr;
+            ++this->stats_.frames;
+        } else {
+            this->startTransaction();
+        }
+
+        return isLast;
+    }
+
+    void startTransaction() {
+        const typename table_t::transaction_t& current = this->table_->transactions()[this->idx_];
+        ++this->stats_.transactions;
+
+        if (table_t::transaction_t::SELECT == current.type) {
+            this->bus_.exchange(table_t::selector(current.group), nullptr, Geometry::NUM_ADCS);
+        } else {
+            this->bus_.selectAdc(current.adcIdx, true);
+            this->bus_.exchange(table_t::adcControl(current.sensorIdx), this->rxBuffer_, ADC_BUFFER_SIZE * this->table_->numSamples());
+        }
+    }
+
+    Bus& bus_;
+    const table_t *table_;
+    measurements_t *measurements_;
+    uint32_t idx_;
+    uint8_t rxBuffer_[ADC_BUFFER_SIZE * MAX_ADC_SAMPLES];
+    uint32_t settleStartTime_;
+    scanMode_t mode_;
+    sampleFilter_t sampleFilter_;
+    bool isOptoEnabled_;
+    stats_t stats_;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <micro/utils/Line.hpp>
+#include <micro/utils/units.hpp>
+
+#include <SensorData.hpp>
+
+// Gets the sensors to scan: the union of the scan ranges, or the whole panel if the scan range radius is 0 or a full scan is required.
+SensorMask getScanMask(const SensorControlData& sensorControl);
+
+// Gets the number of ADC conversions per sensor - at low speed there is time for more conversions per frame.
+uint8_t getNumSamples(const micro::m_per_sec_t speed);
+
+// Lights up the indicator LEDs above the lines.
+void updateIndicatorLeds(Leds& OUT leds, const micro::Lines& lines);
+
+// Centers one scan range on each line - the previous scan ranges are kept if there are no lines.
+void updateScanRanges(SensorControlData& OUT sensorControl, const micro::Lines& lines);
@@ -1,17 +1,33 @@
 #pragma once
 
+#include <micro/container/vec.hpp>
+#include <micro/utils/Line.hpp>
 #include <micro/utils/types.hpp>
+#include <micro/utils/units.hpp>
 
 #include <cfg_sensor.hpp>
 
 #include <array>
+#include <bitset>
 
 typedef std::array<uint8_t, cfg::NUM_SENSORS> Measurements;
 typedef std::array<bool, cfg::NUM_SENSORS> Leds;
+typedef std::bitset<cfg::NUM_SENSORS> SensorMask;
 
 struct SensorControlData {
     Leds leds;
     bool scanEnabled        = false;
-    uint8_t scanRangeCenter = cfg::NUM_SENSORS / 2;
-    uint8_t scanRangeRadius = 0;
+    uint8_t scanRangeRadius = 0;                                            // 0 means the whole panel is scanned
+    bool fullScanRequired   = false;                                        // the whole panel is scanned regardless of the scan ranges
+    uint8_t numSamples      = 1;                                            // number of ADC conversions per sensor
+    micro::vec<uint8_t, micro::Line::MAX_NUM_LINES> scanRangeCenters = { cfg::NUM_SENSORS / 2 }; // one scan range per tracked line
+};
+
+// Measurements of one sensor scan, together with the data needed to follow the frame through the processing stages.
+struct Frame {
+    uint32_t seq = 0;                    // incremented for each acquired frame, gaps mean dropped frames
+    uint32_t scanStartTick = 0;          // microsecond counter value when the scan was started - wraps around, differences must be calculated as unsigned values
+    uint32_t scanEndTick = 0;            // microsecond counter value when the scan was finished
+    SensorMask scanMask;                 // sensors that have been scanned, all other measurements are 0
+    Measurements measurements;
 };
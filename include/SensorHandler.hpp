@@ -5,13 +5,14 @@
 #include <micro/port/spi.hpp>
 #include <micro/port/semaphore.hpp>
 
+#include <OneShotTimer.hpp>
+#include <ScanSequencer.hpp>
 #include <SensorData.hpp>
 
-#include <utility>
-
 class SensorHandler {
 public:
     SensorHandler(const micro::spi_t& spi,
+        const micro::timer_t& settleTimer,
         const micro::vec<micro::gpio_t, cfg::NUM_SENSORS / 8>& adcEnPins,
         const micro::gpio_t& LE_opto,
         const micro::gpio_t& OE_opto,
@@ -20,18 +21,68 @@ public:
 
     void initialize();
 
-    void readSensors(Measurements& OUT measurements, const std::pair<uint8_t, uint8_t>& scanRange);
+    // Reads the given sensors - each sensor is converted numSamples times, and the samples are combined by the sample filter.
+    void readSensors(Measurements& OUT measurements, const SensorMask& sensors, const uint8_t numSamples);
     void writeLeds(const Leds& leds);
 
+    void setScanMode(const scanMode_t mode) {
+        this->sequencer_.setMode(mode);
+    }
+
+    void setSampleFilter(const sampleFilter_t filter) {
+        this->sequencer_.setSampleFilter(filter);
+    }
+
+    // Enables ambient light cancellation: a dark frame is read before every period-th frame,
+    // and the ambient light measured in it is subtracted from the measurements. 0 disables the cancellation.
+    void setAmbientLightPeriod(const uint8_t period) {
+        this->ambientLightPeriod_ = period;
+        this->ambientLightCntr_   = 0;
+        this->ambientSensors_.reset();
+    }
+
+    // Subtracts the ambient light from the measurements - saturates at 0.
+    static void removeAmbientLight(Measurements& OUT measurements, const Measurements& ambientLight) {
+        for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+            measurements[i] = measurements[i] > ambientLight[i] ? measurements[i] - ambientLight[i] : 0;
+        }
+    }
+
     void onTxFinished();
+    void onSettleTimerElapsed();
+
+    const ScanSequencer<SensorHandler>::stats_t& scanStats() const {
+        return this->sequencer_.stats();
+    }
+
+    // Gets the current time in microseconds, see OneShotTimer::now().
+    uint32_t now() const;
 
 private:
-    uint8_t readAdc(const uint8_t channel);
+    friend class ScanSequencer<SensorHandler>;
+
+    void exchange(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size);
+    void latchOpto();
+    void enableOpto(const bool enabled);
+    void selectAdc(const uint8_t adcIdx, const bool selected);
+    void startTimer(const micro::microsecond_t delay);
+
     void exchangeData(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size);
 
+    bool runScan(const ScanTable& table, Measurements& OUT measurements);
+
 private:
     micro::semaphore_t semaphore_;
+    ScanSequencer<SensorHandler> sequencer_;
+    ScanTable scanTable_;
+    ScanTable darkTable_;
+    SensorMask scannedSensors_;
+    Measurements ambientLight_;
+    SensorMask ambientSensors_; // sensors that have an ambient light sample
+    uint8_t ambientLightPeriod_;
+    uint8_t ambientLightCntr_;
     const micro::spi_t spi_;
+    OneShotTimer settleTimer_;
     const micro::vec<micro::gpio_t, cfg::NUM_SENSORS / 8> adcEnPins_;
     const micro::gpio_t LE_opto_;
     const micro::gpio_t OE_opto_;
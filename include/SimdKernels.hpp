@@ -0,0 +1,81 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+// Per-frame kernels of the line position calculation, with one implementation for each instruction set.
+// The functions of the simd namespace use the best backend of the target:
+//     arm    - Cortex-M4 DSP extension: 4 x 8-bit or 2 x 16-bit integer operations in a single instruction,
+//              the FPU has no SIMD, so the floating-point kernels are the scalar ones
+//     sse    - SSE2, available on every x86-64 host
+//     scalar - reference implementation, used on any other target
+// All backends give the same results as the scalar reference, except for the summation order of sum().
+// SIMD_EMULATE_ARM (unit tests only) also builds the arm backend on the host, with the DSP instructions emulated,
+// so that every backend available on the host is tested against the reference.
+#if defined(__ARM_FEATURE_DSP)
+#define SIMD_BACKEND_ARM 1
+#elif defined(__SSE2__)
+#define SIMD_BACKEND_SSE 1
+#endif
+
+#if SIMD_BACKEND_ARM || defined(SIMD_EMULATE_ARM)
+#define SIMD_HAS_ARM 1
+#endif
+
+namespace simd {
+
+namespace scalar {
+
+// result[i] = max(values[i] - offsets[i], 0) * scales[i]
+void normalize(const uint8_t * const values, const uint8_t * const offsets, const float * const scales, float * const OUT result, const uint32_t size);
+
+// sums[i] += values[i]
+void accumulate(uint16_t * const sums, const uint8_t * const values, const uint32_t size);
+
+// Gets the sum of the values.
+float sum(const float * const values, const uint32_t size);
+
+// result[i] = (edgeWeight * values[i] + values[i + 1] + edgeWeight * values[i + 2]) / sumWeight, for i in [0, size - 2)
+void filter3(const float * const values, const float edgeWeight, const float sumWeight, float * const OUT result, const uint32_t size);
+
+// result[i] = 3rd smallest value of values[i - 3 .. i + 3], the window is truncated at the edges
+void thirdSmallest7(const float * const values, float * const OUT result, const uint32_t size);
+
+} // namespace scalar
+
+#if SIMD_HAS_ARM
+
+namespace arm {
+
+void normalize(const uint8_t * const values, const uint8_t * const offsets, const float * const scales, float * const OUT result, const uint32_t size);
+void accumulate(uint16_t * const sums, const uint8_t * const values, const uint32_t size);
+using scalar::sum;
+using scalar::filter3;
+using scalar::thirdSmallest7;
+
+} // namespace arm
+
+#endif
+
+#if SIMD_BACKEND_SSE
+
+namespace sse {
+
+void normalize(const uint8_t * const values, const uint8_t * const offsets, const float * const scales, float * const OUT result, const uint32_t size);
+void accumulate(uint16_t * const sums, const uint8_t * const values, const uint32_t size);
+float sum(const float * const values, const uint32_t size);
+void filter3(const float * const values, const float edgeWeight, const float sumWeight, float * const OUT result, const uint32_t size);
+void thirdSmallest7(const float * const values, float * const OUT result, const uint32_t size);
+
+} // namespace sse
+
+#endif
+
+#if SIMD_BACKEND_ARM
+using namespace arm;
+#elif SIMD_BACKEND_SSE
+using namespace sse;
+#else
+using namespace scalar;
+#endif
+
+} // namespace simd
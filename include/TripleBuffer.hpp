@@ -0,0 +1,73 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+#include <atomic>
+
+// Lock-free single-producer single-consumer channel that always hands over the newest complete value.
+// The producer writes directly into its own buffer, the consumer reads directly from its own buffer,
+// the buffers are only exchanged through the shared middle buffer - no copies are made and none of the sides is ever blocked.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer()
+        : writeIdx_(0)
+        , readIdx_(1)
+        , state_(2)
+        , numOverwritten_(0)
+        , numStaleReads_(0) {}
+
+    // Producer side: the buffer to be filled with the next value.
+    T& writeBuffer() {
+        return this->buffers_[this->writeIdx_];
+    }
+
+    // Producer side: makes the write buffer available to the consumer.
+    // If the consumer has not taken the previously published value, that value is dropped.
+    void publish() {
+        const uint8_t prev = this->state_.exchange(this->writeIdx_ | FRESH_BIT, std::memory_order_acq_rel);
+        this->writeIdx_ = prev & INDEX_MASK;
+
+        if (prev & FRESH_BIT) {
+            ++this->numOverwritten_;
+        }
+    }
+
+    // Consumer side: takes the newest published value, if there is one.
+    // @returns True if a new value has been published since the last read.
+    bool read() {
+        if (!(this->state_.load(std::memory_order_acquire) & FRESH_BIT)) {
+            ++this->numStaleReads_;
+            return false;
+        }
+
+        this->readIdx_ = this->state_.exchange(this->readIdx_, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Consumer side: the value taken by the last successful read.
+    const T& readBuffer() const {
+        return this->buffers_[this->readIdx_];
+    }
+
+    // Number of published values that have been overwritten before the consumer could read them.
+    uint32_t numOverwritten() const {
+        return this->numOverwritten_;
+    }
+
+    // Number of reads that found no new value.
+    uint32_t numStaleReads() const {
+        return this->numStaleReads_;
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH_BIT  = 0x04;
+
+    T buffers_[3];
+    uint8_t writeIdx_;            // owned by the producer
+    uint8_t readIdx_;             // owned by the consumer
+    std::atomic<uint8_t> state_;  // index of the middle buffer and the fresh flag
+    uint32_t numOverwritten_;     // written by the producer
+    uint32_t numStaleReads_;      // written by the consumer
+};
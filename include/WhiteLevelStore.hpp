@@ -0,0 +1,75 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+#include <SensorData.hpp>
+
+#include <cstddef>
+
+// Calculates the CRC-32 (IEEE 802.3) checksum of the data.
+uint32_t crc32(const uint8_t * const data, const uint32_t size);
+
+// White level calibration record, as stored in the non-volatile memory.
+struct WhiteLevelRecord {
+    static constexpr uint32_t MAGIC   = 0x4c564c57; // "WLVL"
+    static constexpr uint16_t VERSION = 1;          // must be incremented when the record layout changes
+
+    uint32_t magic;
+    uint16_t version;
+    uint8_t panelVersion;
+    uint8_t numSensors;
+    Measurements whiteLevels;
+    uint32_t crc;                                   // checksum of all the preceding fields
+
+    uint32_t calculateCrc() const {
+        return crc32(reinterpret_cast<const uint8_t*>(this), offsetof(WhiteLevelRecord, crc));
+    }
+};
+
+// Saves and loads the white level calibration.
+// The Flash type provides the non-volatile memory: the internal flash sector on the panel, or a file on the host.
+// Its interface is:
+//   bool read(uint32_t offset, void *data, uint32_t size) const;
+//   bool erase();
+//   bool write(uint32_t offset, const void *data, uint32_t size);
+template <typename Flash>
+class WhiteLevelStore {
+public:
+    explicit WhiteLevelStore(Flash& flash)
+        : flash_(flash) {}
+
+    // Loads the white levels - fails if there is no valid record for the given panel version.
+    bool load(const uint8_t panelVersion, Measurements& OUT whiteLevels) const {
+        WhiteLevelRecord record;
+        if (!this->flash_.read(0, &record, sizeof(record))           ||
+            WhiteLevelRecord::MAGIC != record.magic                  ||
+            WhiteLevelRecord::VERSION != record.version              ||
+            panelVersion != record.panelVersion                      ||
+            cfg::NUM_SENSORS != record.numSensors                    ||
+            record.calculateCrc() != record.crc) {
+            return false;
+        }
+
+        whiteLevels = record.whiteLevels;
+        return true;
+    }
+
+    // Saves the white levels - the whole storage is erased, so this blocks for the duration of a flash sector erase.
+    bool save(const uint8_t panelVersion, const Measurements& whiteLevels) {
+        WhiteLevelRecord record;
+        record.magic        = WhiteLevelRecord::MAGIC;
+        record.version      = WhiteLevelRecord::VERSION;
+        record.panelVersion = panelVersion;
+        record.numSensors   = cfg::NUM_SENSORS;
+        record.whiteLevels  = whiteLevels;
+        record.crc          = record.calculateCrc();
+
+        // the stored record is read back, so that a failed write is detected before the next boot
+        Measurements storedWhiteLevels;
+        return this->flash_.erase() && this->flash_.write(0, &record, sizeof(record)) &&
+            this->load(panelVersion, storedWhiteLevels) && storedWhiteLevels == whiteLevels;
+    }
+
+private:
+    Flash& flash_;
+};
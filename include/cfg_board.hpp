@@ -31,6 +31,10 @@ extern UART_HandleTypeDef huart2;
 
 #define uart_Debug              micro::uart_t{ &huart2 }
 
+#define FLASH_SECTOR_CALIB      FLASH_SECTOR_1  // reserved in LinkerScript.ld
+#define FLASH_ADDRESS_CALIB     0x08004000
+#define FLASH_SIZE_CALIB        (16 * 1024)
+
 #define PANEL_VERSION_FRONT     0x01
 #define PANEL_VERSION_REAR      0x00
 
@@ -7,15 +7,34 @@ namespace cfg {
 constexpr uint8_t MAX_NUM_FILTERED_LINES             = 6;
 constexpr uint8_t NUM_SENSORS                        = 48;
 constexpr uint8_t WHITE_LEVEL_LINE_GROUP_RADIUS      = 2;
+constexpr uint8_t WHITE_LEVEL_CALIBRATION_FRAMES     = 200;
+constexpr float WHITE_LEVEL_ADAPTATION_RATE          = 0.01f; // weight of each frame in the continuous white level adaptation, 0 disables the adaptation
+constexpr float WHITE_LEVEL_ADAPTATION_MAX_STEP      = 8.0f;  // maximum measurement difference applied to the white levels in a single frame
+constexpr uint8_t WHITE_LEVEL_CHECK_FRAMES           = 10;    // number of frames the loaded white levels are checked against
+constexpr uint8_t WHITE_LEVEL_CHECK_TOLERANCE        = 16;    // maximum difference of the measurements from the loaded white levels
 constexpr uint8_t LINE_POS_CALC_OFFSET_FILTER_RADIUS = 3;
 constexpr float LINE_POS_CALC_INTENSITY_GROUP_RADIUS = 0.5f;
 constexpr float LINE_POS_CALC_GROUP_RADIUS           = 1.0f;
-constexpr micro::millimeter_t MAX_LINE_JUMP          = micro::millimeter_t(20);
+constexpr uint8_t LINE_POS_CALC_MIN_PEAK_DIST        = 4; // minimum distance of the intensity peaks, in sensors
+constexpr float LINE_POS_CALC_PROFILE_SIGMA          = 1.0f; // standard deviation of the intensity profile of a line, in sensors
 constexpr micro::millimeter_t MIN_LINE_DIST          = micro::millimeter_t(25);
-constexpr int8_t LINE_FILTER_HYSTERESIS              = 4;
-constexpr uint8_t LINE_VELO_FILTER_SIZE              = 4;
-constexpr uint8_t LINE_POS_FILTER_WINDOW_SIZE        = 1;
+constexpr micro::millimeter_t LINE_VALIDATION_DISTANCE = micro::millimeter_t(24); // travelled distance a new line needs to be detected over, weighted by the detection probabilities
+constexpr micro::millimeter_t LINE_REMOVAL_DISTANCE    = micro::millimeter_t(24); // travelled distance a line needs to be missed over to be removed
+constexpr uint8_t LINE_FILTER_MIN_FRAMES             = 2;     // minimum number of frames of the validation and the removal, at any speed
+constexpr uint8_t LINE_FILTER_MAX_FRAMES             = 16;    // number of frames after which a line is validated or removed without travelling
+constexpr float LINE_TRACK_MEASUREMENT_NOISE         = 2.0f;  // standard deviation of the detected line positions, in mm
+constexpr float LINE_TRACK_SLOPE_NOISE               = 0.25f; // variance of the slope change of the lines (lateral mm per mm travelled) per mm travelled
+constexpr float LINE_TRACK_INITIAL_SLOPE_NOISE       = 1.0f;  // standard deviation of the slope of new lines
+constexpr float LINE_TRACK_GATE                      = 3.0f;  // maximum difference of a detected line from the predicted position, in standard deviations
+constexpr bool LINE_FILTER_MULTI_HYPOTHESIS          = false; // keeps several line association hypotheses, so that the line IDs survive junctions
+constexpr uint8_t LINE_FILTER_MAX_HYPOTHESES         = 4;     // number of association hypotheses kept in multi-hypothesis mode
+constexpr float LINE_HYPOTHESIS_MISS_COST            = 6.0f;  // cost of a missed line: -2 * ln(1 - detection probability of 95%)
+constexpr float LINE_HYPOTHESIS_NEW_LINE_COST        = 12.0f; // cost of a new line detected with full probability
+constexpr float LINE_HYPOTHESIS_MERGE_COST           = 2.0f;  // cost of a line sharing its detection with other lines
+constexpr uint16_t LINE_HYPOTHESIS_MAX_SEARCH_STEPS  = 32;    // maximum number of association search steps per hypothesis and frame
 constexpr float MIN_LINE_PROBABILITY                 = 0.40f;
 constexpr micro::millimeter_t OPTO_ARRAY_LENGTH      = micro::millimeter_t(274.574f);
+constexpr micro::microsecond_t OPTO_SETTLE_TIME      = micro::microsecond_t(30);
+constexpr uint8_t AMBIENT_LIGHT_PERIOD               = 4; // a dark frame is read before every 4th frame, 0 disables ambient light cancellation
 
 } // namespace cfg
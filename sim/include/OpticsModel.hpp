@@ -0,0 +1,45 @@
+#pragma once
+
+#include <micro/container/vec.hpp>
+#include <micro/utils/Line.hpp>
+#include <micro/utils/units.hpp>
+
+#include <SensorData.hpp>
+
+typedef micro::vec<micro::millimeter_t, micro::Line::MAX_NUM_LINES> LinePositionsMm;
+
+// Light reaching the sensors of the simulated panel.
+class OpticsModel {
+public:
+    virtual ~OpticsModel() {}
+
+    // Gets the ADC value of a sensor: the light of its LED reflected from the track if the LED is lit, plus the ambient light.
+    // @param time Time of the conversion in microseconds
+    virtual uint8_t sample(const uint8_t sensorIdx, const bool isLit, const uint32_t time) = 0;
+
+    // Gets the real positions of the lines under the panel.
+    // @param time Time in microseconds
+    virtual LinePositionsMm lines(const uint32_t time) const = 0;
+};
+
+// Parallel lines swinging sinusoidally under the panel, with constant ambient light and uniform ADC noise.
+class SwingingLinesOptics : public OpticsModel {
+public:
+    struct config_t {
+        uint8_t numLines              = 1;
+        micro::millimeter_t lineDist  = micro::millimeter_t(60);  // distance between the neighboring lines
+        micro::millimeter_t amplitude = micro::millimeter_t(80);  // swing amplitude
+        micro::millisecond_t period   = micro::millisecond_t(1000); // swing period
+        uint8_t ambientLight          = 0;
+        uint8_t noise                 = 0;                        // amplitude of the uniform ADC noise
+    };
+
+    explicit SwingingLinesOptics(const config_t& config);
+
+    uint8_t sample(const uint8_t sensorIdx, const bool isLit, const uint32_t time) override;
+
+    LinePositionsMm lines(const uint32_t time) const override;
+
+private:
+    const config_t config_;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+// Gets the time elapsed since the start of the simulation in microseconds.
+// Same format as the system timer of the panel - wraps around in ~71 minutes.
+uint32_t simTime();
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <micro/utils/units.hpp>
+
+#include <OpticsModel.hpp>
+#include <ScanSequencer.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Simulated sensor SPI bus: opto LED driver shift registers, ADCs and their chip-select lines, with the SPI timing of the panel.
+// The system timer of the panel is simulated here as well, its compare interrupt paces the scans.
+// Transfers and timers are completed at their real deadlines by an interrupt thread, which calls the same callbacks
+// that the DMA and the timer interrupts call on the panel.
+class SimSensorBus {
+public:
+    static constexpr uint32_t SPI_BYTE_TIME = 6; // [us] 8 bits at 1.4 MHz
+
+    SimSensorBus();
+
+    // Starts the interrupt thread.
+    void start(OpticsModel& optics);
+
+    void stop();
+
+    // Peripheral interface of the host port backends
+    void exchange(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size);
+    void latchOpto();
+    void enableOpto(const bool enabled);
+    void selectAdc(const uint8_t adcIdx, const bool selected);
+    void startTimer(const micro::microsecond_t delay);
+    void stopTimer();
+
+private:
+    void runInterrupts();
+
+    uint8_t sample(const uint8_t adcIdx, const uint8_t controlByte);
+
+    OpticsModel *optics_;
+    std::thread interruptThread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool isRunning_;
+    bool isTransferPending_;
+    bool isRxTransfer_;
+    bool isTimerRunning_;
+    uint32_t deadline_;
+    std::array<uint8_t, NUM_ADCS> shiftRegister_;
+    std::array<uint8_t, NUM_ADCS> latched_;
+    bool isOptoEnabled_;
+    int8_t selectedAdc_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <micro/port/can.hpp>
+#include <micro/utils/units.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Simulated vehicle on the CAN bus of the panel: sends the longitudinal state and the line detection control periodically,
+// and passes the frames sent by the panel to a sink.
+// The received frames are signaled from the vehicle thread through the same callback that the RX FIFO interrupt calls on the panel.
+class SimVehicleCan {
+public:
+    typedef std::function<void(const micro::canFrame_t&)> sink_t;
+
+    static constexpr micro::millisecond_t PERIOD = micro::millisecond_t(10);
+
+    SimVehicleCan();
+
+    // Starts the vehicle thread - the sink is called on the thread of the sending task.
+    void start(const micro::m_per_sec_t speed, const uint8_t scanRangeRadius, const sink_t& sink);
+
+    void stop();
+
+    // Peripheral interface of the host port backend
+    void transmit(const micro::canFrame_t& frame);
+    bool receive(micro::canFrame_t& OUT frame);
+
+private:
+    void runVehicle();
+
+    template <typename T, typename ...Args>
+    void send(Args&&... args);
+
+    micro::m_per_sec_t speed_;
+    uint8_t scanRangeRadius_;
+    sink_t sink_;
+    std::thread vehicleThread_;
+    std::atomic<bool> isRunning_;
+    std::mutex mutex_;
+    std::deque<micro::canFrame_t> rxFifo_;
+};
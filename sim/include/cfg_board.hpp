@@ -0,0 +1,40 @@
+#pragma once
+
+#include <micro/port/can.hpp>
+#include <micro/port/gpio.hpp>
+#include <micro/port/spi.hpp>
+#include <micro/port/timer.hpp>
+
+// Board configuration of the simulated panel, in place of include/cfg_board.hpp.
+// The handles refer to the simulated peripherals, the sensor bus pins are identified by their pin numbers.
+
+class SimSensorBus;
+class SimVehicleCan;
+
+extern SimSensorBus  simSensorBus;
+extern SimVehicleCan simVehicleCan;
+
+#define can_Vehicle             micro::can_t{ &simVehicleCan }
+
+#define gpio_SS_ADC0            micro::gpio_t{ &simSensorBus, 0 }
+#define gpio_SS_ADC1            micro::gpio_t{ &simSensorBus, 1 }
+#define gpio_SS_ADC2            micro::gpio_t{ &simSensorBus, 2 }
+#define gpio_SS_ADC3            micro::gpio_t{ &simSensorBus, 3 }
+#define gpio_SS_ADC4            micro::gpio_t{ &simSensorBus, 4 }
+#define gpio_SS_ADC5            micro::gpio_t{ &simSensorBus, 5 }
+
+#define gpio_OE_OPTO            micro::gpio_t{ &simSensorBus, 6 }
+#define gpio_LE_OPTO            micro::gpio_t{ &simSensorBus, 7 }
+#define gpio_OE_IND             micro::gpio_t{ &simSensorBus, 8 }
+#define gpio_LE_IND             micro::gpio_t{ &simSensorBus, 9 }
+
+#define spi_Sensor              micro::spi_t{ &simSensorBus }
+
+#define tim_System              micro::timer_t{ &simSensorBus }
+
+#define FLASH_SECTOR_CALIB      1
+#define FLASH_ADDRESS_CALIB     0x08004000
+#define FLASH_SIZE_CALIB        (16 * 1024)
+
+#define PANEL_VERSION_FRONT     0x01
+#define PANEL_VERSION_REAR      0x00
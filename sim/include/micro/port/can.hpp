@@ -0,0 +1,25 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+namespace micro {
+
+// Host CAN port of the simulator - the frames are exchanged with the simulated vehicle,
+// which calls the same receive callback that the RX FIFO interrupt calls on the panel.
+
+struct can_t {
+    void *handle; // simulated bus
+};
+
+struct canFrame_t {
+    uint16_t id;
+    uint8_t size;
+    uint8_t data[8];
+};
+
+bool can_transmit(const can_t& can, const canFrame_t& frame);
+
+// Reads the oldest frame of the RX FIFO - returns false if the FIFO is empty.
+bool can_receive(const can_t& can, canFrame_t& OUT frame);
+
+} // namespace micro
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+namespace micro {
+
+// Host GPIO port of the simulator - the pins drive the simulated peripheral they belong to.
+
+enum class gpioPinState_t : uint8_t {
+    RESET = 0,
+    SET   = 1
+};
+
+struct gpio_t {
+    void *instance; // simulated peripheral of the pin
+    uint16_t pin;
+};
+
+void gpio_write(const gpio_t& gpio, const gpioPinState_t state);
+
+gpioPinState_t gpio_read(const gpio_t& gpio);
+
+} // namespace micro
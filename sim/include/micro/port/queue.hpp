@@ -0,0 +1,57 @@
+#pragma once
+
+#include <micro/port/task.hpp>
+#include <micro/utils/units.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace micro {
+
+// Host queue of the simulator, in place of the FreeRTOS queue of the panel.
+template <typename T, uint32_t capacity>
+class queue_t {
+public:
+    bool send(const T& value, const millisecond_t timeout = millisecond_t(0)) {
+        os_checkScheduler();
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        if (!this->cv_.wait_for(lock, toDuration(timeout), [this] () { return this->items_.size() < capacity; })) {
+            return false;
+        }
+        this->items_.push_back(value);
+        lock.unlock();
+        this->cv_.notify_all();
+        return true;
+    }
+
+    bool receive(T& OUT value, const millisecond_t timeout = millisecond_t(0)) {
+        os_checkScheduler();
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        if (!this->cv_.wait_for(lock, toDuration(timeout), [this] () { return !this->items_.empty(); })) {
+            return false;
+        }
+        value = this->items_.front();
+        this->items_.pop_front();
+        lock.unlock();
+        this->cv_.notify_all();
+        return true;
+    }
+
+    uint32_t size() const {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        return this->items_.size();
+    }
+
+private:
+    static std::chrono::microseconds toDuration(const millisecond_t timeout) {
+        return std::chrono::microseconds(static_cast<int64_t>(microsecond_t(timeout).get()));
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<T> items_;
+};
+
+} // namespace micro
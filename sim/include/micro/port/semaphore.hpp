@@ -0,0 +1,25 @@
+#pragma once
+
+#include <micro/utils/units.hpp>
+
+#include <condition_variable>
+#include <mutex>
+
+namespace micro {
+
+// Host binary semaphore of the simulator, in place of the FreeRTOS semaphore of the panel.
+class semaphore_t {
+public:
+    semaphore_t();
+
+    void give();
+
+    bool take(const millisecond_t timeout);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool isGiven_;
+};
+
+} // namespace micro
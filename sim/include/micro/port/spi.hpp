@@ -0,0 +1,16 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+namespace micro {
+
+// Host SPI port of the simulator - the transfers are completed by the interrupt thread of the simulated bus,
+// which calls the same transfer complete callbacks that the DMA interrupts call on the panel.
+
+struct spi_t {
+    void *handle; // simulated bus
+};
+
+void spi_exchange(const spi_t& spi, const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size);
+
+} // namespace micro
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <micro/utils/units.hpp>
+
+namespace micro {
+
+// Host task port of the simulator - the tasks run on their own threads.
+// The scheduler can be stopped, which parks every task at its next blocking call, the way the debugger halts the panel.
+
+typedef void (*taskFunction_t)(void);
+
+void os_startTask(const taskFunction_t task);
+
+void os_sleep(const millisecond_t delay);
+
+// Stops the scheduler - returns when every task has been parked.
+void os_stopScheduler();
+
+// Parks the calling task forever if the scheduler has been stopped - called by the blocking port functions.
+// Threads that are not tasks, such as the simulated interrupts, are not parked.
+void os_checkScheduler();
+
+} // namespace micro
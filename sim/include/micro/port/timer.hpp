@@ -0,0 +1,19 @@
+#pragma once
+
+#include <micro/utils/units.hpp>
+
+namespace micro {
+
+// Host timer port of the simulator - the system time is the time elapsed since the start of the simulation.
+
+struct timer_t {
+    void *handle; // simulated timer
+};
+
+void time_init(const timer_t& timer);
+
+millisecond_t getTime();
+
+microsecond_t getExactTime();
+
+} // namespace micro
@@ -0,0 +1,56 @@
+#include <FlashSector.hpp>
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+// Flash sector in the host memory, in place of src/platform/FlashSector.cpp - the stored data is lost at the end of the simulation.
+
+namespace {
+
+constexpr uint8_t ERASED_VALUE = 0xff;
+
+std::map<uint32_t, std::vector<uint8_t>> sectors;
+
+std::vector<uint8_t>& sectorData(const uint32_t sector, const uint32_t size) {
+    std::vector<uint8_t>& data = sectors[sector];
+    if (data.size() != size) {
+        data.assign(size, ERASED_VALUE);
+    }
+    return data;
+}
+
+} // namespace
+
+FlashSector::FlashSector(const uint32_t sector, const uint32_t address, const uint32_t size)
+    : sector_(sector)
+    , address_(address)
+    , size_(size) {}
+
+bool FlashSector::read(const uint32_t offset, void * const data, const uint32_t size) const {
+    if (offset + size > this->size_) {
+        return false;
+    }
+
+    memcpy(data, sectorData(this->sector_, this->size_).data() + offset, size);
+    return true;
+}
+
+bool FlashSector::erase() {
+    sectorData(this->sector_, this->size_).assign(this->size_, ERASED_VALUE);
+    return true;
+}
+
+bool FlashSector::write(const uint32_t offset, const void * const data, const uint32_t size) {
+    if (offset + size > this->size_) {
+        return false;
+    }
+
+    // programming can only clear bits, same as on the flash of the panel
+    std::vector<uint8_t>& sectorBytes = sectorData(this->sector_, this->size_);
+    const uint8_t * const bytes = static_cast<const uint8_t*>(data);
+    for (uint32_t i = 0; i < size; ++i) {
+        sectorBytes[offset + i] &= bytes[i];
+    }
+    return true;
+}
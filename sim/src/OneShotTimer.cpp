@@ -0,0 +1,22 @@
+#include <OneShotTimer.hpp>
+#include <SimPort.hpp>
+#include <SimSensorBus.hpp>
+
+using namespace micro;
+
+// One-shot timer on the simulated system timer, in place of src/OneShotTimer.cpp, which drives the timer registers through the HAL.
+
+OneShotTimer::OneShotTimer(const micro::timer_t& timer)
+    : timer_(timer) {}
+
+uint32_t OneShotTimer::now() const {
+    return simTime();
+}
+
+void OneShotTimer::start(const microsecond_t delay) {
+    static_cast<SimSensorBus*>(this->timer_.handle)->startTimer(delay);
+}
+
+void OneShotTimer::stop() {
+    static_cast<SimSensorBus*>(this->timer_.handle)->stopTimer();
+}
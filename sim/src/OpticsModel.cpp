@@ -0,0 +1,38 @@
+#include <micro/math/numeric.hpp>
+
+#include <LinePosCalculator.hpp>
+#include <OpticsModel.hpp>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace micro;
+
+SwingingLinesOptics::SwingingLinesOptics(const config_t& config)
+    : config_(config) {}
+
+uint8_t SwingingLinesOptics::sample(const uint8_t sensorIdx, const bool isLit, const uint32_t time) {
+    static constexpr float SIGMA = 1.0f; // width of the reflected light of a line, in sensors
+
+    float reflected = 0.0f;
+    if (isLit) {
+        for (const millimeter_t linePos : this->lines(time)) {
+            const float z = (sensorIdx - LinePosCalculator::linePosToOptoPos(linePos)) / SIGMA;
+            reflected += 255.0f * std::exp(-0.5f * z * z);
+        }
+    }
+
+    const int32_t noise = this->config_.noise > 0 ? static_cast<int32_t>(rand() % (2 * this->config_.noise + 1)) - this->config_.noise : 0;
+    return clamp<int32_t>(static_cast<int32_t>(reflected) + this->config_.ambientLight + noise, 0, 255);
+}
+
+LinePositionsMm SwingingLinesOptics::lines(const uint32_t time) const {
+    const float phase = 2 * M_PI * time / microsecond_t(this->config_.period).get();
+    const millimeter_t center = this->config_.amplitude * std::sin(phase);
+
+    LinePositionsMm positions;
+    for (uint8_t i = 0; i < this->config_.numLines; ++i) {
+        positions.push_back(center + (i - (this->config_.numLines - 1) / 2.0f) * this->config_.lineDist);
+    }
+    return positions;
+}
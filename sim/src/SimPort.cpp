@@ -0,0 +1,13 @@
+#include <SimPort.hpp>
+
+#include <chrono>
+
+namespace {
+
+const std::chrono::steady_clock::time_point START_TIME = std::chrono::steady_clock::now();
+
+} // namespace
+
+uint32_t simTime() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - START_TIME).count());
+}
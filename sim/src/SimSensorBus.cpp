@@ -0,0 +1,143 @@
+#include <SimPort.hpp>
+#include <SimSensorBus.hpp>
+
+#include <algorithm>
+
+using namespace micro;
+
+// INTERRUPT CALLBACKS - Defined in the task source files, same as on the panel.
+
+extern void spi_SensorTxCpltCallback();
+extern void spi_SensorTxRxCpltCallback();
+extern void tim_SystemDelayElapsedCallback();
+
+SimSensorBus::SimSensorBus()
+    : optics_(nullptr)
+    , isRunning_(false)
+    , isTransferPending_(false)
+    , isRxTransfer_(false)
+    , isTimerRunning_(false)
+    , deadline_(0)
+    , isOptoEnabled_(false)
+    , selectedAdc_(-1) {
+    this->shiftRegister_.fill(0);
+    this->latched_.fill(0);
+}
+
+void SimSensorBus::start(OpticsModel& optics) {
+    this->optics_          = &optics;
+    this->isRunning_       = true;
+    this->interruptThread_ = std::thread(&SimSensorBus::runInterrupts, this);
+}
+
+void SimSensorBus::stop() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->isRunning_ = false;
+    }
+    this->cv_.notify_one();
+    this->interruptThread_.join();
+}
+
+void SimSensorBus::exchange(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size) {
+    // an ADC burst holds one conversion for each control byte
+    if (this->selectedAdc_ >= 0 && rxBuf) {
+        for (uint32_t i = 0; i + ADC_BUFFER_SIZE <= size; i += ADC_BUFFER_SIZE) {
+            const uint8_t value = this->sample(this->selectedAdc_, txBuf[i]);
+            rxBuf[i]     = 0;
+            rxBuf[i + 1] = value >> 2;
+            rxBuf[i + 2] = (value & 0b11) << 6;
+        }
+    }
+
+    // every byte on the bus is clocked through the opto LED driver shift registers
+    for (uint32_t i = 0; i < size; ++i) {
+        std::rotate(this->shiftRegister_.begin(), std::next(this->shiftRegister_.begin()), this->shiftRegister_.end());
+        this->shiftRegister_[NUM_ADCS - 1] = txBuf[i];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->isTransferPending_ = true;
+        this->isRxTransfer_      = !!rxBuf;
+        this->deadline_          = simTime() + size * SPI_BYTE_TIME;
+    }
+    this->cv_.notify_one();
+}
+
+void SimSensorBus::latchOpto() {
+    this->latched_ = this->shiftRegister_;
+}
+
+void SimSensorBus::enableOpto(const bool enabled) {
+    this->isOptoEnabled_ = enabled;
+}
+
+void SimSensorBus::selectAdc(const uint8_t adcIdx, const bool selected) {
+    this->selectedAdc_ = selected ? adcIdx : -1;
+}
+
+void SimSensorBus::startTimer(const microsecond_t delay) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->isTimerRunning_ = true;
+        this->deadline_ = simTime() + static_cast<uint32_t>(delay.get());
+    }
+    this->cv_.notify_one();
+}
+
+void SimSensorBus::stopTimer() {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->isTimerRunning_ = false;
+}
+
+void SimSensorBus::runInterrupts() {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+
+    while (true) {
+        this->cv_.wait(lock, [this] () { return !this->isRunning_ || this->isTransferPending_ || this->isTimerRunning_; });
+        if (!this->isRunning_) {
+            break;
+        }
+
+        // the sequencer never has a transfer and a timer pending at the same time
+        const bool isTransfer   = this->isTransferPending_;
+        const uint32_t deadline = this->deadline_;
+        lock.unlock();
+
+        // the OS sleep granularity is too coarse for the microsecond deadlines, the interrupt thread spins instead
+        while (static_cast<int32_t>(deadline - simTime()) > 0) {
+            std::this_thread::yield();
+        }
+
+        lock.lock();
+
+        // a timer that has been stopped or restarted in the meantime does not fire, same as a disabled compare interrupt
+        if (isTransfer) {
+            this->isTransferPending_ = false;
+        } else if (this->isTimerRunning_ && this->deadline_ == deadline) {
+            this->isTimerRunning_ = false;
+        } else {
+            continue;
+        }
+
+        const bool isRxTransfer = this->isRxTransfer_;
+        lock.unlock();
+
+        if (!isTransfer) {
+            tim_SystemDelayElapsedCallback();
+        } else if (isRxTransfer) {
+            spi_SensorTxRxCpltCallback();
+        } else {
+            spi_SensorTxCpltCallback();
+        }
+
+        lock.lock();
+    }
+}
+
+uint8_t SimSensorBus::sample(const uint8_t adcIdx, const uint8_t controlByte) {
+    const uint8_t channel = ((controlByte >> 6) & 0b001) | ((controlByte >> 3) & 0b110);
+    const bool isLit = this->isOptoEnabled_ && (this->latched_[adcIdx ^ 1] & (1 << channel));
+    return this->optics_->sample(adcIdx * 8 + channel, isLit, simTime());
+}
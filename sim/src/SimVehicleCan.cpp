@@ -0,0 +1,76 @@
+#include <micro/panel/CanManager.hpp>
+
+#include <SimVehicleCan.hpp>
+
+#include <chrono>
+#include <cstring>
+
+using namespace micro;
+
+// INTERRUPT CALLBACKS - Defined in the task source files, same as on the panel.
+
+extern void micro_Vehicle_Can_RxFifoMsgPendingCallback();
+
+constexpr millisecond_t SimVehicleCan::PERIOD;
+
+SimVehicleCan::SimVehicleCan()
+    : scanRangeRadius_(0)
+    , isRunning_(false) {}
+
+void SimVehicleCan::start(const m_per_sec_t speed, const uint8_t scanRangeRadius, const sink_t& sink) {
+    this->speed_           = speed;
+    this->scanRangeRadius_ = scanRangeRadius;
+    this->sink_            = sink;
+    this->isRunning_       = true;
+    this->vehicleThread_   = std::thread(&SimVehicleCan::runVehicle, this);
+}
+
+void SimVehicleCan::stop() {
+    this->isRunning_ = false;
+    this->vehicleThread_.join();
+}
+
+void SimVehicleCan::transmit(const canFrame_t& frame) {
+    this->sink_(frame);
+}
+
+bool SimVehicleCan::receive(canFrame_t& OUT frame) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (this->rxFifo_.empty()) {
+        return false;
+    }
+
+    frame = this->rxFifo_.front();
+    this->rxFifo_.pop_front();
+    return true;
+}
+
+void SimVehicleCan::runVehicle() {
+    meter_t distance;
+
+    while (this->isRunning_) {
+        distance += this->speed_ * PERIOD;
+        this->send<can::LongitudinalState>(this->speed_, false, distance);
+        this->send<can::LineDetectControl>(true, this->scanRangeRadius_, linePatternDomain_t::Race);
+        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<uint32_t>(PERIOD.get())));
+    }
+}
+
+template <typename T, typename ...Args>
+void SimVehicleCan::send(Args&&... args) {
+    static_assert(sizeof(T) <= sizeof(canFrame_t::data), "Payload must fit into a classic CAN frame");
+
+    const T payload(std::forward<Args>(args)...);
+
+    canFrame_t frame;
+    frame.id   = T::id();
+    frame.size = sizeof(T);
+    memcpy(frame.data, &payload, sizeof(T));
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->rxFifo_.push_back(frame);
+    }
+
+    micro_Vehicle_Can_RxFifoMsgPendingCallback();
+}
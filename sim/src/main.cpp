@@ -0,0 +1,176 @@
+#include <micro/math/numeric.hpp>
+#include <micro/panel/CanManager.hpp>
+#include <micro/port/task.hpp>
+
+#include <cfg_board.hpp>
+#include <FrameStats.hpp>
+#include <LineTrackFrame.hpp>
+#include <OpticsModel.hpp>
+#include <SensorData.hpp>
+#include <SimPort.hpp>
+#include <SimSensorBus.hpp>
+#include <SimVehicleCan.hpp>
+#include <TripleBuffer.hpp>
+
+#include <array>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace micro;
+
+extern "C" void runSensorTask(void);
+extern "C" void runLineCalcTask(void);
+
+extern TripleBuffer<Frame> frameBuffer;
+extern FrameStats frameStats;
+
+SimSensorBus simSensorBus;
+SimVehicleCan simVehicleCan;
+
+namespace {
+
+constexpr uint32_t LATENCY_BUCKET_US = 250;
+constexpr uint32_t NUM_LATENCY_BUCKETS = 20;
+constexpr uint32_t NUM_SETTLE_FRAMES = 250; // the white levels need a few frames to settle, and the line filter needs a few frames to validate the lines
+
+struct config_t {
+    uint32_t duration       = 5;   // [s]
+    uint8_t scanRangeRadius = 0;   // 0 means the whole panel is scanned
+    m_per_sec_t speed       = m_per_sec_t(1.5f);
+    SwingingLinesOptics::config_t optics;
+};
+
+struct results_t {
+    uint32_t numEvaluatedFrames = 0;
+    uint32_t numLineCountErrors = 0; // frames in which the number of lines differs from the real number of lines
+    std::array<uint32_t, 4> numTrackEvents = {}; // by lineTrackEvent_t, spurious births show false detections before they reach the lines
+    millimeter_t sumError;
+    millimeter_t maxError;
+    std::array<uint32_t, NUM_LATENCY_BUCKETS> latencyHistogram = {};
+    microsecond_t sumLatency;
+    microsecond_t sumScanTime;
+};
+
+const OpticsModel *optics = nullptr;
+results_t results;
+
+void evaluateLines(const Frame& frame, const Lines& lines) {
+    const uint32_t scanTime = frame.scanEndTick - frame.scanStartTick;
+    const LinePositionsMm realLines = optics->lines(frame.scanStartTick + scanTime / 2);
+
+    if (lines.size() != realLines.size()) {
+        ++results.numLineCountErrors;
+    }
+
+    for (const Line& l : lines) {
+        millimeter_t error = micro::numeric_limits<millimeter_t>::infinity();
+        for (const millimeter_t realPos : realLines) {
+            error = min(error, abs(realPos - l.pos));
+        }
+        results.sumError += error;
+        results.maxError = max(results.maxError, error);
+    }
+
+    // the latency is measured until the lines are sent
+    const uint32_t latency = simTime() - frame.scanStartTick;
+    ++results.latencyHistogram[min(latency / LATENCY_BUCKET_US, NUM_LATENCY_BUCKETS - 1)];
+    results.sumLatency += microsecond_t(static_cast<float>(latency));
+    results.sumScanTime += microsecond_t(static_cast<float>(scanTime));
+    ++results.numEvaluatedFrames;
+}
+
+template <typename T>
+Lines acquireLines(const canFrame_t& frame) {
+    Lines lines;
+    reinterpret_cast<const T*>(frame.data)->acquire(lines);
+    return lines;
+}
+
+template <typename T>
+lineTrackEvent_t acquireTrackEvent(const canFrame_t& frame) {
+    LineTrack track;
+    lineTrackEvent_t event = lineTrackEvent_t::None;
+    reinterpret_cast<const T*>(frame.data)->acquire(track, event);
+    return event;
+}
+
+// Evaluates the frames sent by the line calculation task against the real lines.
+// The sink is called on the thread of the task, which owns the read buffer of the frames until its next read.
+void onFrameSent(const canFrame_t& canFrame) {
+    const Frame& frame = frameBuffer.readBuffer();
+    if (!frame.scanMask.any() || frame.seq <= NUM_SETTLE_FRAMES) {
+        return;
+    }
+
+    if (can::FrontLines::id() == canFrame.id) {
+        evaluateLines(frame, acquireLines<can::FrontLines>(canFrame));
+    } else if (can::RearLines::id() == canFrame.id) {
+        evaluateLines(frame, acquireLines<can::RearLines>(canFrame));
+    } else if (can::FrontLineTrack::id() == canFrame.id) {
+        ++results.numTrackEvents[static_cast<uint8_t>(acquireTrackEvent<can::FrontLineTrack>(canFrame))];
+    } else if (can::RearLineTrack::id() == canFrame.id) {
+        ++results.numTrackEvents[static_cast<uint8_t>(acquireTrackEvent<can::RearLineTrack>(canFrame))];
+    }
+}
+
+void printResults(const config_t& config) {
+    const float duration = static_cast<float>(config.duration);
+    const uint32_t numFrames = micro::max<uint32_t>(results.numEvaluatedFrames, 1);
+
+    std::cout << "frames:   " << frameStats.numFrames() << " processed (" << frameStats.numFrames() / duration << " Hz), "
+              << frameStats.numDropped() << " dropped, " << frameBuffer.numOverwritten() << " overwritten, "
+              << results.numEvaluatedFrames << " evaluated" << std::endl;
+    std::cout << "scan:     " << (results.sumScanTime / numFrames).get() << " us on average" << std::endl;
+    std::cout << "latency:  " << (results.sumLatency / numFrames).get() << " us on average, "
+              << frameStats.maxLatency().get() << " us max (scan start to send)" << std::endl;
+    std::cout << "accuracy: " << (results.sumError / numFrames).get() << " mm on average, " << results.maxError.get() << " mm max, "
+              << results.numLineCountErrors << " frames with wrong line count" << std::endl;
+    std::cout << "tracks:   " << results.numTrackEvents[static_cast<uint8_t>(lineTrackEvent_t::Born)] << " born, "
+              << results.numTrackEvents[static_cast<uint8_t>(lineTrackEvent_t::Validated)] << " validated, "
+              << results.numTrackEvents[static_cast<uint8_t>(lineTrackEvent_t::Lost)] << " lost" << std::endl;
+
+    std::cout << "latency histogram:" << std::endl;
+    for (uint32_t i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+        std::cout << std::setw(6) << i * LATENCY_BUCKET_US << " us: " << results.latencyHistogram[i] << std::endl;
+    }
+}
+
+} // namespace
+
+// Runs the sensor and the line calculation tasks of the panel on the host port backends, with simulated sensor optics and vehicle.
+// The lines are evaluated from the CAN frames sent by the panel.
+// usage: line_detector_sim [duration_s] [num_lines] [ambient_light] [noise] [speed_mps] [scan_range_radius]
+int main(int argc, char *argv[]) {
+    config_t config;
+
+    if (argc > 1) config.duration               = std::stoul(argv[1]);
+    if (argc > 2) config.optics.numLines        = std::stoul(argv[2]);
+    if (argc > 3) config.optics.ambientLight    = std::stoul(argv[3]);
+    if (argc > 4) config.optics.noise           = std::stoul(argv[4]);
+    if (argc > 5) config.speed                  = m_per_sec_t(std::stof(argv[5]));
+    if (argc > 6) config.scanRangeRadius        = std::stoul(argv[6]);
+
+    SwingingLinesOptics swingingLines(config.optics);
+    optics = &swingingLines;
+
+    simSensorBus.start(swingingLines);
+    simVehicleCan.start(config.speed, config.scanRangeRadius, onFrameSent);
+    os_startTask(runSensorTask);
+    os_startTask(runLineCalcTask);
+
+    std::this_thread::sleep_for(std::chrono::seconds(config.duration));
+
+    // the results are only read once the tasks have been parked
+    os_stopScheduler();
+    simVehicleCan.stop();
+    simSensorBus.stop();
+
+    printResults(config);
+
+    // the parked tasks are never joined, so the static objects they use must not be destroyed
+    std::cout.flush();
+    std::quick_exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,16 @@
+#include <micro/port/can.hpp>
+
+#include <SimVehicleCan.hpp>
+
+namespace micro {
+
+bool can_transmit(const can_t& can, const canFrame_t& frame) {
+    static_cast<SimVehicleCan*>(can.handle)->transmit(frame);
+    return true;
+}
+
+bool can_receive(const can_t& can, canFrame_t& OUT frame) {
+    return static_cast<SimVehicleCan*>(can.handle)->receive(frame);
+}
+
+} // namespace micro
@@ -0,0 +1,28 @@
+#include <micro/port/gpio.hpp>
+
+#include <cfg_board.hpp>
+#include <SimSensorBus.hpp>
+
+namespace micro {
+
+void gpio_write(const gpio_t& gpio, const gpioPinState_t state) {
+    SimSensorBus * const bus = static_cast<SimSensorBus*>(gpio.instance);
+
+    // the chip-select and output enable lines are active low, the latch is taken on the rising edge
+    if (gpio.pin < NUM_ADCS) {
+        bus->selectAdc(gpio.pin, gpioPinState_t::RESET == state);
+    } else if (gpio_OE_OPTO.pin == gpio.pin) {
+        bus->enableOpto(gpioPinState_t::RESET == state);
+    } else if (gpio_LE_OPTO.pin == gpio.pin && gpioPinState_t::SET == state) {
+        bus->latchOpto();
+    }
+
+    // the indicator LEDs are not simulated
+}
+
+gpioPinState_t gpio_read(const gpio_t&) {
+    // the simulated panel has no input pins
+    return gpioPinState_t::RESET;
+}
+
+} // namespace micro
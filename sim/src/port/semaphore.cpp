@@ -0,0 +1,29 @@
+#include <micro/port/semaphore.hpp>
+#include <micro/port/task.hpp>
+
+#include <chrono>
+
+namespace micro {
+
+semaphore_t::semaphore_t()
+    : isGiven_(false) {}
+
+void semaphore_t::give() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->isGiven_ = true;
+    }
+    this->cv_.notify_one();
+}
+
+bool semaphore_t::take(const millisecond_t timeout) {
+    os_checkScheduler();
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    const bool isGiven = this->cv_.wait_for(lock, std::chrono::microseconds(static_cast<uint32_t>(microsecond_t(timeout).get())),
+        [this] () { return this->isGiven_; });
+    this->isGiven_ = false;
+    return isGiven;
+}
+
+} // namespace micro
@@ -0,0 +1,11 @@
+#include <micro/port/spi.hpp>
+
+#include <SimSensorBus.hpp>
+
+namespace micro {
+
+void spi_exchange(const spi_t& spi, const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size) {
+    static_cast<SimSensorBus*>(spi.handle)->exchange(txBuf, rxBuf, size);
+}
+
+} // namespace micro
@@ -0,0 +1,58 @@
+#include <micro/port/task.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace micro {
+
+namespace {
+
+std::mutex schedulerMutex;
+std::condition_variable schedulerCv;
+bool isSchedulerRunning = true;
+uint32_t numTasks       = 0;
+uint32_t numParkedTasks = 0;
+thread_local bool isTask = false; // the interrupt threads use the port functions as well, but they are never parked
+
+} // namespace
+
+void os_startTask(const taskFunction_t task) {
+    {
+        std::lock_guard<std::mutex> lock(schedulerMutex);
+        ++numTasks;
+    }
+
+    // the tasks never return, and the parked ones are never resumed
+    std::thread([task] () {
+        isTask = true;
+        task();
+    }).detach();
+}
+
+void os_sleep(const millisecond_t delay) {
+    os_checkScheduler();
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<uint32_t>(microsecond_t(delay).get())));
+}
+
+void os_stopScheduler() {
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+    isSchedulerRunning = false;
+    schedulerCv.wait(lock, [] () { return numParkedTasks == numTasks; });
+}
+
+void os_checkScheduler() {
+    if (!isTask) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+    if (!isSchedulerRunning) {
+        ++numParkedTasks;
+        schedulerCv.notify_all();
+        schedulerCv.wait(lock, [] () { return false; });
+    }
+}
+
+} // namespace micro
@@ -0,0 +1,17 @@
+#include <micro/port/timer.hpp>
+
+#include <SimPort.hpp>
+
+namespace micro {
+
+void time_init(const timer_t&) {}
+
+millisecond_t getTime() {
+    return getExactTime();
+}
+
+microsecond_t getExactTime() {
+    return microsecond_t(simTime());
+}
+
+} // namespace micro
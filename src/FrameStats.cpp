@@ -0,0 +1,46 @@
+#include <micro/math/numeric.hpp>
+
+#include <FrameStats.hpp>
+
+using namespace micro;
+
+FrameStats::FrameStats()
+    : numFrames_(0)
+    , numDropped_(0)
+    , lastSeq_(0)
+    , scanStartTick_(0)
+    , scanEndTick_(0)
+    , processStartTick_(0)
+    , maxLatency_(0) {
+
+    for (uint32_t& t : this->stageTimes_) {
+        t = 0;
+    }
+}
+
+void FrameStats::begin(const Frame& frame, const uint32_t tick) {
+    // the sequence numbers start from 1, so the first frame is not counted as a gap
+    if (frame.seq > this->lastSeq_ + 1) {
+        this->numDropped_ += frame.seq - this->lastSeq_ - 1;
+    }
+
+    this->lastSeq_          = frame.seq;
+    this->scanStartTick_    = frame.scanStartTick;
+    this->scanEndTick_      = frame.scanEndTick;
+    this->processStartTick_ = tick;
+
+    for (uint32_t& t : this->stageTimes_) {
+        t = 0;
+    }
+
+    ++this->numFrames_;
+}
+
+void FrameStats::stamp(const frameStage_t stage, const uint32_t tick) {
+    const uint32_t stageTime = tick - this->scanStartTick_;
+    this->stageTimes_[static_cast<uint8_t>(stage)] = stageTime;
+
+    if (frameStage_t::Send == stage) {
+        this->maxLatency_ = max(this->maxLatency_, stageTime);
+    }
+}
@@ -2,125 +2,503 @@
 #include <micro/math/numeric.hpp>
 #include <LineFilter.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
 using namespace micro;
 
-Lines LineFilter::update(const LinePositions& detectedLines) {
+namespace {
+
+constexpr int8_t UNMATCHED = -1;
+
+// Finds the globally optimal assignment of the detected lines to the filtered lines:
+// the most pairs within the LINE_TRACK_GATE, and the smallest sum of normalized innovations among those.
+// The number of lines is small, so the assignments are searched depth-first, trying only the pairs within the gate,
+// and cutting the branches that cannot beat the best assignment anymore. Unlike a greedy matching of the closest pairs,
+// the line IDs are not swapped when two lines move close to each other, e.g. in junctions.
+class LineAssigner {
+public:
+    // the squared differences of the detected lines from the predicted positions, normalized by their variances
+    typedef float costs_t[Line::MAX_NUM_LINES][cfg::MAX_NUM_FILTERED_LINES];
+
+    struct assignment_t {
+        int8_t filteredIdx[Line::MAX_NUM_LINES]; // the filtered line of each detected line, or UNMATCHED
+        uint8_t numPairs = 0;
+        float costSum = 0.0f;
+    };
 
-    typedef vec<LinePositions::const_iterator, cfg::MAX_NUM_FILTERED_LINES> linePositionIterators_t;
-    linePositionIterators_t unmatchedDetectedLines;
-    for (LinePositions::const_iterator it = detectedLines.begin(); it != detectedLines.end(); ++it) {
-        unmatchedDetectedLines.push_back(it);
+    LineAssigner(const costs_t& costs, const uint8_t numDetected, const uint8_t numFiltered)
+        : costs_(costs)
+        , numDetected_(numDetected)
+        , numFiltered_(numFiltered) {
+        std::fill(std::begin(this->best_.filteredIdx), std::end(this->best_.filteredIdx), UNMATCHED);
     }
 
-    typedef vec<filteredLines_t::iterator, cfg::MAX_NUM_FILTERED_LINES> filteredLineIterators_t;
-    filteredLineIterators_t unmatchedFilteredLines;
-    for (filteredLines_t::iterator it = this->lines_.begin(); it != this->lines_.end(); ++it) {
-        unmatchedFilteredLines.push_back(it);
+    const assignment_t& solve() {
+        assignment_t current;
+        std::fill(std::begin(current.filteredIdx), std::end(current.filteredIdx), UNMATCHED);
+        this->search(0, 0, current);
+        return this->best_;
     }
 
-    // updates estimated positions for all filtered lines
-    for (filteredLine_t& l : this->lines_) {
-        const millimeter_t current = l.current_raw();
+private:
+    void search(const uint8_t detectedIdx, const uint8_t usedFiltered, assignment_t& current) {
+        const uint8_t maxNumPairs = current.numPairs + this->numDetected_ - detectedIdx;
+        if (maxNumPairs < this->best_.numPairs || (maxNumPairs == this->best_.numPairs && current.costSum >= this->best_.costSum)) {
+            return;
+        }
+
+        if (detectedIdx == this->numDetected_) {
+            this->best_ = current;
+            return;
+        }
 
-        l.estimated = l.samples.size() >= cfg::LINE_VELO_FILTER_SIZE ?
-            current + (current - l.samples.peek_back(cfg::LINE_VELO_FILTER_SIZE - 1)) / cfg::LINE_VELO_FILTER_SIZE :
-            current;
+        for (uint8_t j = 0; j < this->numFiltered_; ++j) {
+            const float cost = this->costs_[detectedIdx][j];
+            if (!(usedFiltered & (1 << j)) && cost < cfg::LINE_TRACK_GATE * cfg::LINE_TRACK_GATE) {
+                current.filteredIdx[detectedIdx] = j;
+                ++current.numPairs;
+                current.costSum += cost;
+
+                this->search(detectedIdx + 1, usedFiltered | (1 << j), current);
+
+                --current.numPairs;
+                current.costSum -= cost;
+            }
+        }
+
+        current.filteredIdx[detectedIdx] = UNMATCHED;
+        this->search(detectedIdx + 1, usedFiltered, current);
     }
 
-    struct posMapping_t {
-        linePositionIterators_t::iterator detectedLine;
-        filteredLineIterators_t::iterator filteredLine;
-        millimeter_t diff;
-    };
+    const costs_t& costs_;
+    const uint8_t numDetected_;
+    const uint8_t numFiltered_;
+    assignment_t best_;
+};
+
+static_assert(cfg::MAX_NUM_FILTERED_LINES <= 8, "Used filtered lines must fit in the bit mask");
+
+// variance of a detection that is the merged image of lines closer than MIN_LINE_DIST to each other,
+// each line may be anywhere within MIN_LINE_DIST around the detected position, in mm^2
+const float MERGED_MEASUREMENT_VAR = cfg::MIN_LINE_DIST.get() * cfg::MIN_LINE_DIST.get() / 12;
 
-    typedef vec<posMapping_t, Line::MAX_NUM_LINES * cfg::MAX_NUM_FILTERED_LINES> posMappings_t;
+constexpr float NO_PAIR = std::numeric_limits<float>::max();
 
-    // finds all close position pairs from the current and the previous measurements (expected positions), and updates filtered lines
-    while (unmatchedDetectedLines.size() && unmatchedFilteredLines.size()) {
+static_assert(Line::MAX_NUM_LINES <= 8, "Used detected lines must fit in the bit mask");
+static_assert(cfg::LINE_HYPOTHESIS_MAX_SEARCH_STEPS > cfg::MAX_NUM_FILTERED_LINES, "The first association must be found within the search step limit");
 
-        // maps all previous and current line positions to each other
-        posMappings_t posMappings;
-        for (linePositionIterators_t::iterator detectedLine = unmatchedDetectedLines.begin(); detectedLine != unmatchedDetectedLines.end(); ++detectedLine) {
-            for (filteredLineIterators_t::iterator filteredLine = unmatchedFilteredLines.begin(); filteredLine != unmatchedFilteredLines.end(); ++filteredLine) {
-                posMappings.push_back({ detectedLine, filteredLine, abs((*detectedLine)->pos - (*filteredLine)->estimated) });
+} // namespace
+
+void LineFilter::HypothesisGenerator::reset() {
+    this->best_.clear();
+    this->maxNumSteps_ = 0;
+}
+
+void LineFilter::HypothesisGenerator::search(const uint8_t hypothesisIdx, const float hypothesisCost, const costs_t& costs) {
+    this->costs_ = &costs;
+    this->numSteps_ = 0;
+
+    // the sums of the cheapest choices of the filtered lines from each index on are the lower bounds of the branches,
+    // a filtered line is cheapest as the second line of a merged image, which it may be after the choice of an earlier line
+    this->minRemainingCosts_[costs.numFiltered] = 0.0f;
+    for (int8_t j = costs.numFiltered - 1; j >= 0; --j) {
+        choices_t& choices = this->choices_[j];
+        choices.clear();
+        choices.insert({ UNMATCHED, false, cfg::LINE_HYPOTHESIS_MISS_COST });
+
+        float minCost = cfg::LINE_HYPOTHESIS_MISS_COST;
+        for (uint8_t i = 0; i < costs.numDetected; ++i) {
+            if (costs.pair[j][i] != NO_PAIR) {
+                choices.insert({ static_cast<int8_t>(i), false, costs.pair[j][i] });
+                minCost = min(minCost, costs.pair[j][i]);
+            }
+
+            // the merged images are ordered by the cheapest second line
+            float minExtraCost = NO_PAIR;
+            for (uint8_t k = j + 1; k < costs.numFiltered; ++k) {
+                minExtraCost = min(minExtraCost, costs.mergedExtra[k][i]);
+            }
+
+            if (costs.merged[j][i] != NO_PAIR && minExtraCost != NO_PAIR) {
+                choices.insert({ static_cast<int8_t>(i), true, costs.merged[j][i] + minExtraCost });
             }
+            minCost = min(minCost, costs.mergedExtra[j][i]);
         }
 
-        // finds closest pair in the line position map
-        const posMappings_t::iterator closest = std::min_element(posMappings.begin(), posMappings.end(), [] (const posMapping_t& a, const posMapping_t& b) {
-            return a.diff < b.diff;
-        });
+        this->minRemainingCosts_[j] = this->minRemainingCosts_[j + 1] + minCost;
+    }
 
-        // will be accepted as valid position pairs of the previous and the current measurement if they are close enough to each other
-        if (closest->diff < cfg::MAX_LINE_JUMP) {
-            (*closest->filteredLine)->samples.push_back((*closest->detectedLine)->pos);
-            (*closest->filteredLine)->increaseCntr();
-        } else {
-            // no more close pairs found
-            break;
+    candidate_t current;
+    current.hypothesisIdx = hypothesisIdx;
+    std::fill(std::begin(current.detectedIdx), std::end(current.detectedIdx), UNMATCHED);
+
+    // the second lines of the merged images are chosen with the first ones
+    int8_t forcedDetectedIdx[cfg::MAX_NUM_FILTERED_LINES];
+    std::fill(std::begin(forcedDetectedIdx), std::end(forcedDetectedIdx), UNMATCHED);
+
+    this->search(0, hypothesisCost, 0, current, forcedDetectedIdx);
+    this->maxNumSteps_ = max(this->maxNumSteps_, this->numSteps_);
+}
+
+bool LineFilter::HypothesisGenerator::isPruned(const float cost) const {
+    return this->best_.size() == this->best_.capacity() && cost >= this->best_[this->best_.size() - 1].cost;
+}
+
+void LineFilter::HypothesisGenerator::search(const uint8_t filteredIdx, const float cost, const uint8_t usedDetected, candidate_t& current, int8_t forcedDetectedIdx[]) {
+    const costs_t& costs = *this->costs_;
+
+    // the step limit only cuts the search after the first association has been found,
+    // the first branch is never pruned and ends in an association within MAX_NUM_FILTERED_LINES + 1 steps
+    if (this->isPruned(cost + this->minRemainingCosts_[filteredIdx]) ||
+        (this->numSteps_ >= cfg::LINE_HYPOTHESIS_MAX_SEARCH_STEPS && this->best_.size())) {
+        return;
+    }
+    ++this->numSteps_;
+
+    if (filteredIdx == costs.numFiltered) {
+        // the detected lines without filtered lines start new lines
+        current.cost = cost;
+        for (uint8_t i = 0; i < costs.numDetected; ++i) {
+            if (!(usedDetected & (1 << i))) {
+                current.cost += costs.newLine[i];
+            }
         }
 
-        // pair has been handled, removes them from their correspondent list
-        unmatchedDetectedLines.erase(closest->detectedLine);
-        unmatchedFilteredLines.erase(closest->filteredLine);
+        if (!this->isPruned(current.cost)) {
+            if (this->best_.size() == this->best_.capacity()) {
+                this->best_.erase(&this->best_[this->best_.size() - 1]);
+            }
+            this->best_.insert(current);
+        }
+        return;
     }
 
-    // decreases counters for unmatched previous lines
-    for (filteredLines_t::iterator it : unmatchedFilteredLines) {
-        it->decreaseCntr();
-        it->samples.push_back(it->estimated);
+    const int8_t forced = forcedDetectedIdx[filteredIdx];
+    if (UNMATCHED != forced) {
+        current.detectedIdx[filteredIdx] = forced;
+        this->search(filteredIdx + 1, cost + costs.mergedExtra[filteredIdx][forced], usedDetected, current, forcedDetectedIdx);
+        return;
     }
 
-    // erases lines from the filtered lines list that have not been detected for a given number of measurements
-    for (filteredLines_t::const_iterator it = this->lines_.begin(); it != this->lines_.end();) {
-        if (-cfg::LINE_FILTER_HYSTERESIS == it->cntr) {
-            it = this->lines_.erase(it);
+    for (const choice_t& choice : this->choices_[filteredIdx]) {
+        const int8_t i = choice.detectedIdx;
+        current.detectedIdx[filteredIdx] = i;
+
+        if (UNMATCHED == i) {
+            this->search(filteredIdx + 1, cost + cfg::LINE_HYPOTHESIS_MISS_COST, usedDetected, current, forcedDetectedIdx);
+        } else if (usedDetected & (1 << i)) {
+            continue;
+        } else if (!choice.isMerged) {
+            this->search(filteredIdx + 1, cost + costs.pair[filteredIdx][i], usedDetected | (1 << i), current, forcedDetectedIdx);
         } else {
-            ++it;
+            for (uint8_t k = filteredIdx + 1; k < costs.numFiltered; ++k) {
+                if (UNMATCHED == forcedDetectedIdx[k] && costs.mergedExtra[k][i] != NO_PAIR) {
+                    forcedDetectedIdx[k] = i;
+                    this->search(filteredIdx + 1, cost + costs.merged[filteredIdx][i], usedDetected | (1 << i), current, forcedDetectedIdx);
+                    forcedDetectedIdx[k] = UNMATCHED;
+                }
+            }
         }
     }
+}
 
-    // if a line has been in the filtered lines list for at least LINE_FILTER_HYSTERESIS measurements, then it is a valid line
-    for (filteredLine_t& l : this->lines_) {
-        if (cfg::LINE_FILTER_HYSTERESIS == l.cntr) {
-            l.isValidated = true;
-        }
+void LineFilter::setMultiHypothesisEnabled(const bool enabled) {
+    if (enabled && !this->isMultiHypothesisEnabled_) {
+        // the tracked lines are kept as the only hypothesis
+        this->hypotheses_.clear();
+        this->hypotheses_.push_back(hypothesis_t{ this->lines_, 0.0f });
+    } else if (!enabled && this->isMultiHypothesisEnabled_) {
+        // continues from the most likely hypothesis
+        this->lines_ = this->hypotheses_[0].lines;
     }
 
-    // added unmatched detected lines to the filtered lines list
-    for (LinePositions::const_iterator it : unmatchedDetectedLines) {
-        filteredLine_t newLine;
-        newLine.id = this->generateNewLineId();
-        newLine.cntr = 1;
-        newLine.isValidated = false;
-        newLine.samples.push_back(it->pos);
-        this->lines_.insert(newLine);
+    this->isMultiHypothesisEnabled_ = enabled;
+}
+
+Lines LineFilter::update(const LinePositions& detectedLines, const millimeter_t distance) {
+
+    if (this->isMultiHypothesisEnabled_) {
+        this->updateMultiHypothesis(detectedLines, distance);
+    } else {
+        this->updateSingleHypothesis(detectedLines, distance);
     }
 
     // output list will contain all validated lines from the filtered lines list
+    const filteredLines_t& lines = this->isMultiHypothesisEnabled_ ? this->hypotheses_[0].lines : this->lines_;
+    this->updateTracks(lines);
+
     Lines trackedLines;
-    for (const filteredLine_t& l : this->lines_) {
+    for (const filteredLine_t& l : lines) {
         if (l.isValidated) {
-            trackedLines.insert({ l.current(), l.id });
+            trackedLines.insert({ l.pos, l.id });
         }
     }
 
     return trackedLines;
 }
 
-millimeter_t LineFilter::filteredLine_t::current() const {
-    const uint32_t size = min<uint32_t>(this->samples.size(), cfg::LINE_POS_FILTER_WINDOW_SIZE);
-    millimeter_t pos;
+void LineFilter::updateSingleHypothesis(const LinePositions& detectedLines, const millimeter_t distance) {
+
+    // moves all filtered lines to their expected positions
+    for (filteredLine_t& l : this->lines_) {
+        l.predict(distance);
+    }
+
+    // maps all current line positions to the expected ones
+    LineAssigner::costs_t costs;
+    for (uint8_t i = 0; i < detectedLines.size(); ++i) {
+        for (uint8_t j = 0; j < this->lines_.size(); ++j) {
+            const float innovation = (detectedLines[i].pos - this->lines_[j].pos).get();
+            costs[i][j] = innovation * innovation / this->lines_[j].innovationVar();
+        }
+    }
+
+    const LineAssigner::assignment_t assignment = LineAssigner(costs, detectedLines.size(), this->lines_.size()).solve();
+
+    association_t association;
+    std::fill(std::begin(association), std::end(association), UNMATCHED);
+    for (uint8_t i = 0; i < detectedLines.size(); ++i) {
+        if (UNMATCHED != assignment.filteredIdx[i]) {
+            association[assignment.filteredIdx[i]] = i;
+        }
+    }
+
+    applyAssociation(this->lines_, detectedLines, association, distance);
+}
+
+void LineFilter::updateMultiHypothesis(const LinePositions& detectedLines, const millimeter_t distance) {
+
+    // a detection is a line with its probability, a weak detection is less likely to belong to a line
+    float detectionCosts[Line::MAX_NUM_LINES];
+    for (uint8_t i = 0; i < detectedLines.size(); ++i) {
+        detectionCosts[i] = -2 * std::log(max(detectedLines[i].probability, 0.01f));
+    }
+
+    HypothesisGenerator& generator = this->hypothesisGenerator_;
+    HypothesisGenerator::costs_t& costs = this->hypothesisCosts_;
+    generator.reset();
+
+    for (uint8_t h = 0; h < this->hypotheses_.size(); ++h) {
+        filteredLines_t& lines = this->hypotheses_[h].lines;
+
+        // moves all filtered lines to their expected positions
+        for (filteredLine_t& l : lines) {
+            l.predict(distance);
+        }
+
+        costs.numFiltered = lines.size();
+        costs.numDetected = detectedLines.size();
+
+        for (uint8_t i = 0; i < detectedLines.size(); ++i) {
+            costs.newLine[i] = cfg::LINE_HYPOTHESIS_NEW_LINE_COST * detectedLines[i].probability;
+        }
+
+        for (uint8_t j = 0; j < lines.size(); ++j) {
+            // the variance terms make the lines with uncertain positions less likely to match, the costs are 0 for a perfect match
+            const float pairVar       = lines[j].innovationVar();
+            const float mergedVar     = lines[j].innovationVar(MERGED_MEASUREMENT_VAR);
+            const float pairVarCost   = std::log(pairVar / filteredLine_t::MEASUREMENT_VAR);
+            const float mergedVarCost = std::log(mergedVar / filteredLine_t::MEASUREMENT_VAR);
+
+            for (uint8_t i = 0; i < detectedLines.size(); ++i) {
+                const float innovation = (detectedLines[i].pos - lines[j].pos).get();
+                const float pairNis    = innovation * innovation / pairVar;
+                const float mergedNis  = innovation * innovation / mergedVar;
+
+                costs.pair[j][i] = pairNis < cfg::LINE_TRACK_GATE * cfg::LINE_TRACK_GATE ? pairNis + pairVarCost + detectionCosts[i] : NO_PAIR;
+
+                // a merged image is one detection, its likelihood is only counted once, the second line only needs to be close to it
+                if (mergedNis < cfg::LINE_TRACK_GATE * cfg::LINE_TRACK_GATE) {
+                    costs.merged[j][i]      = mergedNis + mergedVarCost + detectionCosts[i];
+                    costs.mergedExtra[j][i] = mergedNis + cfg::LINE_HYPOTHESIS_MERGE_COST;
+                } else {
+                    costs.merged[j][i] = costs.mergedExtra[j][i] = NO_PAIR;
+                }
+            }
+        }
+
+        generator.search(h, this->hypotheses_[h].cost, costs);
+    }
+
+    // the best associations of all hypotheses become the new hypotheses, their costs relative to the most likely one
+    const HypothesisGenerator::candidates_t& candidates = generator.candidates();
+    this->nextHypotheses_.clear();
+    for (const HypothesisGenerator::candidate_t& c : candidates) {
+        this->nextHypotheses_.push_back(hypothesis_t{ this->hypotheses_[c.hypothesisIdx].lines, c.cost - candidates[0].cost });
+        hypothesis_t& next = this->nextHypotheses_[this->nextHypotheses_.size() - 1];
+        applyAssociation(next.lines, detectedLines, c.detectedIdx, distance);
+
+        // the children of different parents end up with the same lines when the lines the parents disagreed on are lost,
+        // the duplicates would take the slots of the alternatives, so only the most likely one is kept - the candidates are sorted by cost
+        const bool isDuplicate = std::any_of(this->nextHypotheses_.begin(), &next, [&next] (const hypothesis_t& h) {
+            return isSameTrackSet(h.lines, next.lines);
+        });
+        if (isDuplicate) {
+            this->nextHypotheses_.erase(&next);
+        }
+    }
+
+    this->hypotheses_ = this->nextHypotheses_;
+}
+
+bool LineFilter::isSameTrackSet(const filteredLines_t& a, const filteredLines_t& b) {
+    // the same tracks closer than the measurement noise cannot be told apart by the detections
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [] (const filteredLine_t& la, const filteredLine_t& lb) {
+        return la.id == lb.id && la.isValidated == lb.isValidated && abs(la.pos - lb.pos).get() < cfg::LINE_TRACK_MEASUREMENT_NOISE;
+    });
+}
+
+void LineFilter::applyAssociation(filteredLines_t& lines, const LinePositions& detectedLines, const association_t& association, const millimeter_t distance) {
+
+    // a detection shared by several filtered lines is their merged image, it is only the centroid of the lines
+    uint8_t numShares[Line::MAX_NUM_LINES] = {};
+    millimeter_t sharedPosSums[Line::MAX_NUM_LINES];
+    for (uint8_t j = 0; j < lines.size(); ++j) {
+        if (UNMATCHED != association[j]) {
+            ++numShares[association[j]];
+            sharedPosSums[association[j]] += lines[j].pos;
+        }
+    }
+
+    // corrects the matched filtered lines, the unmatched ones continue from their expected positions and count their misses
+    for (uint8_t j = 0; j < lines.size(); ++j) {
+        filteredLine_t& l = lines[j];
+        if (UNMATCHED != association[j]) {
+            const LinePosition& detected = detectedLines[association[j]];
+            const uint8_t n = numShares[association[j]];
+            if (n > 1) {
+                // the lines of a merged image are shifted together, so their order and their slopes relative to each other are kept,
+                // and the lines crossing each other come out of the junction on the right sides
+                l.correct(l.pos + detected.pos - sharedPosSums[association[j]] / n, MERGED_MEASUREMENT_VAR);
+            } else {
+                l.correct(detected.pos);
+            }
+            l.onDetected(distance, detected.probability);
+        } else {
+            l.onMissed(distance);
+        }
+    }
+
+    // erases lines from the filtered lines list that have not been detected over the removal distance
+    for (filteredLines_t::const_iterator it = lines.begin(); it != lines.end();) {
+        if (it->isLost()) {
+            it = lines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // if a line has been detected over the validation distance, then it is a valid line
+    for (filteredLine_t& l : lines) {
+        if (l.isConfirmed()) {
+            l.isValidated = true;
+        }
+    }
+
+    // added unmatched detected lines to the filtered lines list
+    for (uint8_t i = 0; i < detectedLines.size(); ++i) {
+        if (!numShares[i]) {
+            filteredLine_t newLine;
+            newLine.id = generateNewLineId(lines);
+            newLine.isValidated = false;
+            newLine.initialize(detectedLines[i].pos);
+            newLine.onDetected(distance, detectedLines[i].probability);
+            lines.insert(newLine);
+        }
+    }
+}
+
+void LineFilter::filteredLine_t::initialize(const millimeter_t measured) {
+    this->pos      = measured;
+    this->slope    = 0.0f;
+    this->posVar   = cfg::LINE_TRACK_MEASUREMENT_NOISE * cfg::LINE_TRACK_MEASUREMENT_NOISE;
+    this->covar    = 0.0f;
+    this->slopeVar = cfg::LINE_TRACK_INITIAL_SLOPE_NOISE * cfg::LINE_TRACK_INITIAL_SLOPE_NOISE;
+}
+
+void LineFilter::filteredLine_t::predict(const millimeter_t distance) {
+    // the slope changes continuously by a random amount, the uncertainty grows with the distance and not with the number of frames,
+    // so the same distance gives the same prediction, whether it is travelled in one frame or in several
+    const float d    = distance.get();
+    const float absD = abs(d);
+
+    this->pos      += millimeter_t(this->slope * d);
+    this->posVar   += 2 * d * this->covar + d * d * this->slopeVar + cfg::LINE_TRACK_SLOPE_NOISE * absD * absD * absD / 3;
+    this->covar    += d * this->slopeVar + cfg::LINE_TRACK_SLOPE_NOISE * d * absD / 2;
+    this->slopeVar += cfg::LINE_TRACK_SLOPE_NOISE * absD;
+}
+
+void LineFilter::filteredLine_t::correct(const millimeter_t measured, const float measurementVar) {
+    const float innovationVar = this->innovationVar(measurementVar);
+    const float posGain       = this->posVar / innovationVar;
+    const float slopeGain     = this->covar / innovationVar;
+    const float innovation    = (measured - this->pos).get();
+
+    this->pos      += millimeter_t(innovation * posGain);
+    this->slope    += innovation * slopeGain;
+    this->slopeVar -= slopeGain * this->covar;
+    this->posVar   *= 1.0f - posGain;
+    this->covar    *= 1.0f - posGain;
+}
+
+void LineFilter::updateTracks(const filteredLines_t& lines) {
 
-    for (uint32_t i = 0; i < size; ++i) {
-        pos += this->samples.peek_back(i);
+    // the events are found by comparing the lines to the previous tracks instead of being recorded when the lines change,
+    // so that in multi-hypothesis mode they follow the most likely hypothesis, even when it switches to another one
+    LineTracks tracks;
+    bool isBorn[cfg::MAX_NUM_FILTERED_LINES] = {};
+    bool isNewlyValidated[cfg::MAX_NUM_FILTERED_LINES] = {};
+    bool isContinued[cfg::MAX_NUM_FILTERED_LINES] = {};
+
+    for (uint8_t j = 0; j < lines.size(); ++j) {
+        const filteredLine_t& l = lines[j];
+
+        LineTrack track;
+        track.id              = l.id;
+        track.pos             = l.pos;
+        track.slope           = l.slope;
+        track.age             = l.age;
+        track.numMissedFrames = l.numMissedFrames;
+        track.confidence      = l.confidence;
+        track.isValidated     = l.isValidated;
+        tracks.push_back(track);
+
+        // an ID reused in the frame of its birth belongs to a new line
+        const LineTracks::const_iterator prev = std::find_if(this->tracks_.begin(), this->tracks_.end(), [&l] (const LineTrack& t) { return l.id == t.id; });
+        if (prev != this->tracks_.end() && l.age > 1) {
+            isContinued[prev - this->tracks_.begin()] = true;
+            isNewlyValidated[j] = l.isValidated && !prev->isValidated;
+        } else {
+            isBorn[j] = true;
+            isNewlyValidated[j] = l.isValidated;
+        }
+    }
+
+    // the lost lines are reported first, so that a reused ID is not mistaken for the lost line
+    this->events_.clear();
+    for (uint8_t i = 0; i < this->tracks_.size(); ++i) {
+        if (!isContinued[i]) {
+            this->events_.push_back({ lineTrackEvent_t::Lost, this->tracks_[i] });
+        }
+    }
+
+    for (uint8_t j = 0; j < tracks.size(); ++j) {
+        if (isBorn[j]) {
+            this->events_.push_back({ lineTrackEvent_t::Born, tracks[j] });
+        }
+        if (isNewlyValidated[j]) {
+            this->events_.push_back({ lineTrackEvent_t::Validated, tracks[j] });
+        }
     }
 
-    return pos / size;
+    this->tracks_ = tracks;
 }
 
-uint8_t LineFilter::generateNewLineId() {
+uint8_t LineFilter::generateNewLineId(const filteredLines_t& lines) {
     uint8_t id = 1;
-    while (std::find_if(this->lines_.begin(), this->lines_.end(), [id] (const filteredLine_t& l) { return id == l.id; }) != this->lines_.end()) { ++id; }
+    while (std::find_if(lines.begin(), lines.end(), [id] (const filteredLine_t& l) { return id == l.id; }) != lines.end()) { ++id; }
     return id;
 }
@@ -2,170 +2,511 @@
 #include <micro/math/unit_utils.hpp>
 
 #include <LinePosCalculator.hpp>
+#include <SimdKernels.hpp>
 
-#include <numeric>
+#include <cmath>
+#include <functional>
+#include <limits>
 
 using namespace micro;
 
-LinePosCalculator::LinePosCalculator(const bool whiteLevelCalibrationEnabled)
-    : whiteLevelCalibrationEnabled_(whiteLevelCalibrationEnabled) {
-    this->whiteLevels_.fill(0);
+namespace {
+
+// Line intensity profile for the matched filter estimator - a Gaussian with the standard deviation of the line profile.
+struct MatchedFilterKernel {
+    static constexpr int32_t RADIUS = 2;
+    static constexpr uint8_t SIZE   = 2 * RADIUS + 1;
+
+    float weights[SIZE];
+
+    MatchedFilterKernel() {
+        for (int32_t i = -RADIUS; i <= RADIUS; ++i) {
+            this->weights[i + RADIUS] = std::exp(-0.5f * i * i / (cfg::LINE_POS_CALC_PROFILE_SIGMA * cfg::LINE_POS_CALC_PROFILE_SIGMA));
+        }
+    }
+};
+
+const MatchedFilterKernel MATCHED_FILTER_KERNEL;
+
+// Gets the offset of the vertex of the peak through 3 equidistant values from the middle one, in [-0.5, 0.5].
+// A Gaussian is fitted if all values are positive (a parabola through their logarithms), otherwise a parabola.
+float interpolatePeak(const float left, const float center, const float right) {
+    float l = left, c = center, r = right;
+    if (l > 0.0f && c > 0.0f && r > 0.0f) {
+        l = std::log(l);
+        c = std::log(c);
+        r = std::log(r);
+    }
+
+    const float denominator = l - 2 * c + r;
+    return denominator < 0.0f ? micro::clamp(0.5f * (l - r) / denominator, -0.5f, 0.5f) : 0.0f;
+}
+
+// the sum of the calibration frames must not overflow the accumulators
+static_assert(cfg::WHITE_LEVEL_CALIBRATION_FRAMES * 255 <= std::numeric_limits<uint16_t>::max(), "White level sum overflow");
+
+} // namespace
+
+template <typename Geometry>
+BasicLinePosCalculator<Geometry>::BasicLinePosCalculator(const bool whiteLevelCalibrationEnabled)
+    : whiteLevelCalibrationEnabled_(whiteLevelCalibrationEnabled)
+    , offsetFilterEnabled_(true)
+    , estimator_(linePosEstimator_t::Centroid)
+    , whiteLevelAdaptationEnabled_(false)
+    , numCalibrationFrames_(0)
+    , numAdaptedFrames_(0)
+    , numCheckFrames_(0)
+    , numFailedCheckFrames_(0)
+    , hasUnsavedWhiteLevels_(false) {
+    this->resetWhiteLevels();
 }
 
-LinePositions LinePosCalculator::calculate(const Measurements& measurements) {
+template <typename Geometry>
+LinePositions BasicLinePosCalculator<Geometry>::calculate(const measurements_t& measurements, const sensorMask_t& activeSensors) {
     LinePositions positions;
 
-    if (!this->whiteLevelCalibrationEnabled_ || this->whiteLevelCalibrationBuffer_.size() == this->whiteLevelCalibrationBuffer_.capacity()) {
-        positions = this->runCalculation(measurements);
-    } else {
+    if (activeSensors.none()) {
+        return positions;
+    }
+
+    // the white levels of all sensors are needed, the partial frames are only used after the calibration
+    const bool isFullFrame = activeSensors.all();
+
+    if (this->whiteLevelAdaptationEnabled_ && !this->isCalibrated() && isFullFrame) {
+        this->initProvisionalWhiteLevels(measurements);
+    }
+
+    if (this->isCalibrated()) {
+        positions = this->runCalculation(measurements, activeRanges(activeSensors));
+
+        if (this->isCheckingWhiteLevels()) {
+            this->checkWhiteLevels(measurements, activeSensors, positions);
+            if (!this->isCalibrated()) {
+                // the white levels did not match the surface, the lines calculated with them are not valid either
+                return LinePositions();
+            }
+        }
+
+        if (this->whiteLevelAdaptationEnabled_) {
+            this->adaptWhiteLevels(measurements, activeSensors, positions);
+        }
+    } else if (isFullFrame) {
         this->runCalibration(measurements);
     }
 
     return positions;
 }
 
-millimeter_t LinePosCalculator::optoIdxToLinePos(const float optoIdx) {
-    return map(optoIdx, 0.0f, cfg::NUM_SENSORS - 1.0f, -cfg::OPTO_ARRAY_LENGTH / 2, cfg::OPTO_ARRAY_LENGTH / 2);
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::setWhiteLevels(const measurements_t& whiteLevels) {
+    this->whiteLevels_ = whiteLevels;
+    std::copy(whiteLevels.begin(), whiteLevels.end(), this->whiteLevelEstimates_.begin());
+    this->updateWhiteLevelScales();
+
+    this->numCalibrationFrames_  = cfg::WHITE_LEVEL_CALIBRATION_FRAMES;
+    this->numAdaptedFrames_      = cfg::WHITE_LEVEL_CALIBRATION_FRAMES;
+    this->numCheckFrames_        = cfg::WHITE_LEVEL_CHECK_FRAMES;
+    this->numFailedCheckFrames_  = 0;
+    this->hasUnsavedWhiteLevels_ = false;
 }
 
-float LinePosCalculator::linePosToOptoPos(const micro::millimeter_t linePos) {
-    return map(linePos, -cfg::OPTO_ARRAY_LENGTH / 2, cfg::OPTO_ARRAY_LENGTH / 2, 0.0f, cfg::NUM_SENSORS - 1.0f);
+template <typename Geometry>
+millimeter_t BasicLinePosCalculator<Geometry>::optoIdxToLinePos(const float optoIdx) {
+    return map(optoIdx, 0.0f, Geometry::NUM_SENSORS - 1.0f, -Geometry::ARRAY_LENGTH / 2, Geometry::ARRAY_LENGTH / 2);
 }
 
-LinePositions LinePosCalculator::runCalculation(const Measurements& measurements) {
-    static constexpr float MAX_GROUP_INTENSITY = 1.0f / (1.0f + cfg::LINE_POS_CALC_INTENSITY_GROUP_RADIUS);
-
-    LinePositions positions;
+template <typename Geometry>
+float BasicLinePosCalculator<Geometry>::linePosToOptoPos(const micro::millimeter_t linePos) {
+    return map(linePos, -Geometry::ARRAY_LENGTH / 2, Geometry::ARRAY_LENGTH / 2, 0.0f, Geometry::NUM_SENSORS - 1.0f);
+}
 
-    float intensities[cfg::NUM_SENSORS];
-    this->normalize(measurements, intensities);
+template <typename Geometry>
+LinePositions BasicLinePosCalculator<Geometry>::runCalculation(const measurements_t& measurements, const sensorRanges_t& ranges) {
+    static constexpr float MAX_GROUP_INTENSITY = 1.0f / (1.0f + Geometry::INTENSITY_GROUP_RADIUS);
 
-    if (std::accumulate(&intensities[0], &intensities[cfg::NUM_SENSORS], 0.0f) / cfg::NUM_SENSORS < 0.3f) {
-        groupIntensities_t groupIntensities = calculateGroupIntensities(intensities);
+    LinePositions positions;
 
-        const float minGroupIntensity = std::min_element(groupIntensities.begin(), groupIntensities.end())->intensity;
-        uint8_t lastInsertedIdx       = 255;
+    float intensities[Geometry::NUM_SENSORS];
+    this->normalize(measurements, ranges, intensities);
 
-        while (positions.size() < positions.capacity() && !groupIntensities.empty()) {
+    // the mean intensity of the active sensors, the inactive ones would make any frame look white
+    float intensitySum = 0.0f;
+    uint8_t numActiveSensors = 0;
+    for (const std::pair<uint8_t, uint8_t>& range : ranges) {
+        intensitySum += simd::sum(&intensities[range.first], range.second - range.first);
+        numActiveSensors += range.second - range.first;
+    }
 
-            const groupIntensities_t::const_iterator candidate = std::max_element(groupIntensities.begin(), groupIntensities.end());
+    if (intensitySum / numActiveSensors < 0.3f) {
+        const groupIntensities_t groupIntensities = calculateGroupIntensities(intensities, ranges);
+        const float minGroupIntensity = groupIntensities.empty() ? 0.0f : std::min_element(groupIntensities.begin(), groupIntensities.end())->intensity;
 
-            if (micro::abs(static_cast<int32_t>(lastInsertedIdx) - static_cast<int32_t>(candidate->centerIdx)) >= 4) {
-                const millimeter_t linePos = calculateLinePos(intensities, candidate->centerIdx);
-                const float probability = map(candidate->intensity, minGroupIntensity, MAX_GROUP_INTENSITY, 0.0f, 1.0f);
+        for (const groupIntensity_t& peak : findPeaks(groupIntensities)) {
+            const float probability = map(peak.intensity, minGroupIntensity, MAX_GROUP_INTENSITY, 0.0f, 1.0f);
 
-                if (probability < cfg::MIN_LINE_PROBABILITY) {
-                    break;
-                }
+            if (positions.size() == positions.capacity() || probability < cfg::MIN_LINE_PROBABILITY) {
+                break;
+            }
 
-                if (std::find_if(positions.begin(), positions.end(), [linePos] (const LinePosition& pos) {
-                    return abs(pos.pos - linePos) <= cfg::MIN_LINE_DIST;
-                }) == positions.end()) {
-                    positions.insert({ linePos, probability });
-                }
+            const millimeter_t linePos = this->calculateLinePos(intensities, peak.centerIdx);
 
-                lastInsertedIdx = candidate->centerIdx;
+            if (std::find_if(positions.begin(), positions.end(), [linePos] (const LinePosition& pos) {
+                return abs(pos.pos - linePos) <= cfg::MIN_LINE_DIST;
+            }) == positions.end()) {
+                positions.insert({ linePos, probability });
             }
-
-            groupIntensities.erase(candidate);
         }
     }
 
     return positions;
 }
 
-void LinePosCalculator::runCalibration(const Measurements& measurements) {
-    this->whiteLevelCalibrationBuffer_.push_back(measurements);
-    if (this->whiteLevelCalibrationBuffer_.size() == this->whiteLevelCalibrationBuffer_.capacity()) {
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::runCalibration(const measurements_t& measurements) {
+    simd::accumulate(this->whiteLevelSums_.data(), measurements.data(), Geometry::NUM_SENSORS);
 
-        const LinePositions linePositions = this->runCalculation(measurements);
+    if (++this->numCalibrationFrames_ == cfg::WHITE_LEVEL_CALIBRATION_FRAMES) {
 
-        for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
-            float sum = 0.0f;
-            for (const Measurements& meas : this->whiteLevelCalibrationBuffer_) {
-                sum += meas[i];
-            }
-            this->whiteLevels_[i] = micro::round(sum / this->whiteLevelCalibrationBuffer_.size());
+        const LinePositions linePositions = this->runCalculation(measurements, { { 0, Geometry::NUM_SENSORS } });
+
+        for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+            this->whiteLevels_[i] = micro::round(static_cast<float>(this->whiteLevelSums_[i]) / cfg::WHITE_LEVEL_CALIBRATION_FRAMES);
         }
 
         this->updateInvalidWhiteLevels(linePositions);
+        this->updateWhiteLevelScales();
+        this->hasUnsavedWhiteLevels_ = true;
     }
 }
 
-void LinePosCalculator::updateInvalidWhiteLevels(const LinePositions& linePositions) {
-    Measurements sortedWhiteLevels;
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::updateInvalidWhiteLevels(const LinePositions& linePositions) {
+    measurements_t sortedWhiteLevels;
     std::copy(this->whiteLevels_.begin(), this->whiteLevels_.end(), sortedWhiteLevels.begin());
     std::sort(sortedWhiteLevels.begin(), sortedWhiteLevels.end());
-    const uint8_t whiteLevelMedian = sortedWhiteLevels[cfg::NUM_SENSORS / 2];
+    const uint8_t whiteLevelMedian = sortedWhiteLevels[Geometry::NUM_SENSORS / 2];
 
     for (const LinePosition& linePos : linePositions) {
-        const uint8_t sensorIdx = micro::round(linePosToOptoPos(linePos.pos));
+        const std::pair<uint8_t, uint8_t> range = lineSensorRange(linePos);
+        std::fill(std::next(this->whiteLevels_.begin(), range.first), std::next(this->whiteLevels_.begin(), range.second), whiteLevelMedian);
+    }
+}
+
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::initProvisionalWhiteLevels(const measurements_t& measurements) {
+    // the lines cover only a few sensors, so the measurements above the median are replaced with the median
+    measurements_t sortedMeasurements = measurements;
+    std::nth_element(sortedMeasurements.begin(), std::next(sortedMeasurements.begin(), Geometry::NUM_SENSORS / 2), sortedMeasurements.end());
+    const uint8_t median = sortedMeasurements[Geometry::NUM_SENSORS / 2];
+
+    for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+        this->whiteLevels_[i] = min(measurements[i], median);
+        this->whiteLevelEstimates_[i] = this->whiteLevels_[i];
+    }
+
+    this->updateWhiteLevelScales();
+    this->numCalibrationFrames_ = cfg::WHITE_LEVEL_CALIBRATION_FRAMES; // the provisional white levels replace the calibration
+    this->numAdaptedFrames_     = 0;
+}
 
-        const std::pair<Measurements::iterator, Measurements::iterator> range = {
-            std::next(this->whiteLevels_.begin(), max<uint8_t>(sensorIdx, cfg::WHITE_LEVEL_LINE_GROUP_RADIUS) - cfg::WHITE_LEVEL_LINE_GROUP_RADIUS),
-            std::next(this->whiteLevels_.begin(), min<uint8_t>(sensorIdx + cfg::WHITE_LEVEL_LINE_GROUP_RADIUS + 1, cfg::NUM_SENSORS))
-        };
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::checkWhiteLevels(const measurements_t& measurements, const sensorMask_t& activeSensors, const LinePositions& linePositions) {
+    const lineSensors_t isLine = lineSensors(linePositions);
 
-        for (Measurements::iterator it = range.first; it != range.second; ++it) {
-            *it = whiteLevelMedian;
+    uint8_t numMismatches = 0;
+    for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+        if (activeSensors.test(i) && !isLine[i] && abs(measurements[i] - this->whiteLevels_[i]) > cfg::WHITE_LEVEL_CHECK_TOLERANCE) {
+            ++numMismatches;
         }
     }
+
+    // a few mismatching sensors are tolerated, they may be covered by undetected lines
+    if (numMismatches > activeSensors.count() / 4) {
+        ++this->numFailedCheckFrames_;
+    }
+
+    if (0 == --this->numCheckFrames_ && this->numFailedCheckFrames_ > cfg::WHITE_LEVEL_CHECK_FRAMES / 2) {
+        this->resetWhiteLevels();
+    }
 }
 
-void LinePosCalculator::normalize(const Measurements& measurements, float * const OUT result) {
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::resetWhiteLevels() {
+    this->whiteLevels_.fill(0);
+    this->whiteLevelSums_.fill(0);
+    this->whiteLevelEstimates_.fill(0.0f);
+    this->updateWhiteLevelScales();
+    this->numCalibrationFrames_ = 0;
+    this->numAdaptedFrames_     = 0;
+}
 
-    float scaled[cfg::NUM_SENSORS];
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::adaptWhiteLevels(const measurements_t& measurements, const sensorMask_t& activeSensors, const LinePositions& linePositions) {
+    const lineSensors_t isLine = lineSensors(linePositions);
 
-    // removes sensor-specific offset
-    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
-        scaled[i] = micro::map<uint8_t>(measurements[i], this->whiteLevels_[i], 255, 0.0f, 1.0f);
+    for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+        if (!activeSensors.test(i) || isLine[i]) {
+            continue;
+        }
+
+        // the step is limited, so that undetected lines or short reflections cannot pull the white level away
+        float& estimate = this->whiteLevelEstimates_[i];
+        estimate += cfg::WHITE_LEVEL_ADAPTATION_RATE * clamp(measurements[i] - estimate, -cfg::WHITE_LEVEL_ADAPTATION_MAX_STEP, cfg::WHITE_LEVEL_ADAPTATION_MAX_STEP);
+
+        // the scale is only recalculated when the white level changes
+        const uint8_t whiteLevel = micro::round(estimate);
+        if (whiteLevel != this->whiteLevels_[i]) {
+            this->whiteLevels_[i] = whiteLevel;
+            this->whiteLevelScales_[i] = whiteLevelScale(whiteLevel);
+        }
     }
 
+    if (this->numAdaptedFrames_ < cfg::WHITE_LEVEL_CALIBRATION_FRAMES && ++this->numAdaptedFrames_ == cfg::WHITE_LEVEL_CALIBRATION_FRAMES) {
+        this->hasUnsavedWhiteLevels_ = true;
+    }
+}
+
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::updateWhiteLevelScales() {
+    for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+        this->whiteLevelScales_[i] = whiteLevelScale(this->whiteLevels_[i]);
+    }
+}
+
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::normalize(const measurements_t& measurements, const sensorRanges_t& ranges, float * const OUT result) {
+
+    // the inactive sensors are treated as white
+    std::fill(&result[0], &result[Geometry::NUM_SENSORS], 0.0f);
+
+    if (!this->offsetFilterEnabled_) {
+        for (const std::pair<uint8_t, uint8_t>& range : ranges) {
+            // removes sensor-specific offset
+            simd::normalize(&measurements[range.first], &this->whiteLevels_[range.first], &this->whiteLevelScales_[range.first],
+                &result[range.first], range.second - range.first);
+        }
+        return;
+    }
+
+    float scaled[Geometry::NUM_SENSORS];
+    std::fill(&scaled[0], &scaled[Geometry::NUM_SENSORS], 0.0f);
+
+    for (const std::pair<uint8_t, uint8_t>& range : ranges) {
+        // removes sensor-specific offset
+        simd::normalize(&measurements[range.first], &this->whiteLevels_[range.first], &this->whiteLevelScales_[range.first],
+            &scaled[range.first], range.second - range.first);
+    }
+
+    // the windows of the sensors at the edges of a range reach into the neighboring sensors, which are white if not scanned,
+    // so that the offsets of narrow ranges are not taken from the line sensors themselves
+    for (const std::pair<uint8_t, uint8_t>& range : ranges) {
+        const uint8_t first = std::max(range.first, Geometry::OFFSET_FILTER_RADIUS) - Geometry::OFFSET_FILTER_RADIUS;
+        const uint8_t last  = std::min<uint8_t>(range.second + Geometry::OFFSET_FILTER_RADIUS, Geometry::NUM_SENSORS);
+        float filtered[Geometry::NUM_SENSORS];
+
+        filterOffset(&scaled[first], filtered, last - first);
+        std::copy(&filtered[range.first - first], &filtered[range.second - first], &result[range.first]);
+    }
+}
+
+template <typename Geometry>
+void BasicLinePosCalculator<Geometry>::filterOffset(const float * const scaled, float * const OUT result, const uint8_t size) {
+    // the offset is the 1/3 percentile of the full window
+    static_assert(Geometry::OFFSET_FILTER_RADIUS == 3, "Offset filter kernel works on a window of 7 sensors");
+
+    float offsets[Geometry::NUM_SENSORS];
+    simd::thirdSmallest7(scaled, offsets, size);
+
     // removes dynamic light-related offset, that applies to the neighboring sensors
-    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
-        const uint8_t startIdx = max<uint8_t>(i, cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS) - cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS;
-        const uint8_t endIdx = min<uint8_t>(i + cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS + 1, cfg::NUM_SENSORS);
+    for (uint8_t i = 0; i < size; ++i) {
+        result[i] = map(scaled[i], offsets[i], 1.0f, 0.0f, 1.0f);
+    }
+}
 
-        std::array<float, 2 * cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS + 1> group;
-        std::copy(&scaled[startIdx], &scaled[endIdx], group.begin());
-        std::sort(group.begin(), std::next(group.begin(), endIdx - startIdx));
+template <typename Geometry>
+typename BasicLinePosCalculator<Geometry>::sensorRanges_t BasicLinePosCalculator<Geometry>::activeRanges(const sensorMask_t& activeSensors) {
+    sensorRanges_t ranges;
+    for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+        if (!activeSensors.test(i)) {
+            continue;
+        }
 
-        result[i] = map(scaled[i], group[group.size() / 3], 1.0f, 0.0f, 1.0f);
+        if (ranges.size() && ranges[ranges.size() - 1].second == i) {
+            ++ranges[ranges.size() - 1].second;
+        } else {
+            ranges.push_back({ i, static_cast<uint8_t>(i + 1) });
+        }
     }
+    return ranges;
 }
 
-LinePosCalculator::groupIntensities_t LinePosCalculator::calculateGroupIntensities(const float * const intensities) {
+template <typename Geometry>
+typename BasicLinePosCalculator<Geometry>::groupIntensities_t BasicLinePosCalculator<Geometry>::calculateGroupIntensities(const float * const intensities, const sensorRanges_t& ranges) {
 
-    static constexpr WeightCalculator CALC(cfg::LINE_POS_CALC_INTENSITY_GROUP_RADIUS);
+    static constexpr WeightCalculator CALC(Geometry::INTENSITY_GROUP_RADIUS);
+    static_assert(CALC.radius == 1, "Group intensity kernel works on a window of 3 sensors");
 
+    // the groups never reach over the edges of the active ranges
     groupIntensities_t groupIntensities;
-    for (uint8_t groupIdx = CALC.radius; groupIdx < cfg::NUM_SENSORS - CALC.radius; ++groupIdx) {
-        float groupIntensity = 0.0f;
-        for (int8_t subIdx = -CALC.radius; subIdx <= CALC.radius; ++subIdx) {
-            groupIntensity += CALC.weight(subIdx) * intensities[groupIdx + subIdx];
+    for (const std::pair<uint8_t, uint8_t>& range : ranges) {
+        if (range.second - range.first <= 2 * CALC.radius) {
+            continue;
         }
 
-        groupIntensities.push_back({ groupIdx, groupIntensity / CALC.sumWeight });
+        float filtered[Geometry::NUM_SENSORS - 2 * CALC.radius];
+        simd::filter3(&intensities[range.first], CALC.lastWeight, CALC.sumWeight, filtered, range.second - range.first);
+
+        for (uint8_t groupIdx = range.first + CALC.radius; groupIdx < range.second - CALC.radius; ++groupIdx) {
+            groupIntensities.push_back({ groupIdx, filtered[groupIdx - range.first - CALC.radius] });
+        }
     }
     return groupIntensities;
 }
 
-millimeter_t LinePosCalculator::calculateLinePos(const float * const intensities, const uint8_t centerIdx) {
+template <typename Geometry>
+typename BasicLinePosCalculator<Geometry>::peaks_t BasicLinePosCalculator<Geometry>::findPeaks(const groupIntensities_t& groupIntensities) {
+    static constexpr int32_t RADIUS = cfg::LINE_POS_CALC_MIN_PEAK_DIST - 1;
+
+    // min-heap of the strongest peaks, the weakest one is replaced when a stronger peak is found
+    peaks_t peaks;
+    const std::greater<groupIntensity_t> heapCompare;
+
+    const int32_t size = static_cast<int32_t>(groupIntensities.size());
+    for (int32_t i = 0; i < size; ++i) {
+        const float intensity = groupIntensities[i].intensity;
+
+        // a peak is the maximum of its neighborhood, equal values are resolved to the first one, so that plateaus give a single peak
+        // the groups are ordered by their center, but there may be gaps between the active ranges
+        const int32_t centerIdx = groupIntensities[i].centerIdx;
+        bool isPeak = true;
+        for (int32_t j = i - 1; isPeak && j >= 0 && groupIntensities[j].centerIdx >= centerIdx - RADIUS; --j) {
+            isPeak = groupIntensities[j].intensity < intensity;
+        }
+        for (int32_t j = i + 1; isPeak && j < size && groupIntensities[j].centerIdx <= centerIdx + RADIUS; ++j) {
+            isPeak = groupIntensities[j].intensity <= intensity;
+        }
+
+        if (!isPeak) {
+            continue;
+        }
+
+        if (peaks.size() < peaks.capacity()) {
+            peaks.push_back(groupIntensities[i]);
+            std::push_heap(peaks.begin(), peaks.end(), heapCompare);
+        } else if (intensity > peaks[0].intensity) {
+            std::pop_heap(peaks.begin(), peaks.end(), heapCompare);
+            peaks[peaks.size() - 1] = groupIntensities[i];
+            std::push_heap(peaks.begin(), peaks.end(), heapCompare);
+        }
+    }
+
+    // strongest peak first
+    std::sort_heap(peaks.begin(), peaks.end(), heapCompare);
+    return peaks;
+}
+
+template <typename Geometry>
+millimeter_t BasicLinePosCalculator<Geometry>::calculateLinePos(const float * const intensities, const uint8_t centerIdx) const {
+    float optoIdx = 0.0f;
+
+    switch (this->estimator_) {
+    case linePosEstimator_t::MatchedFilter:
+        optoIdx = estimateMatchedFilter(intensities, centerIdx);
+        break;
+    case linePosEstimator_t::PeakFit:
+        optoIdx = estimatePeakFit(intensities, centerIdx);
+        break;
+    default:
+        optoIdx = estimateCentroid(intensities, centerIdx);
+        break;
+    }
+
+    return optoIdxToLinePos(optoIdx);
+}
+
+template <typename Geometry>
+float BasicLinePosCalculator<Geometry>::estimateCentroid(const float * const intensities, const uint8_t centerIdx) {
 
-    const WeightCalculator calc(cfg::LINE_POS_CALC_GROUP_RADIUS, centerIdx);
+    // the group centers are never closer to the edges than the intensity group radius,
+    // so the whole group always fits, and the weights are compile-time constants
+    static constexpr WeightCalculator CALC(Geometry::GROUP_RADIUS);
+    static_assert(micro::round_up(Geometry::INTENSITY_GROUP_RADIUS) >= CALC.radius, "Line position group must fit next to the panel edges");
 
     float sum  = 0;
     float sumW = 0;
 
-    for (int8_t subIdx = -calc.radius; subIdx <= calc.radius; ++subIdx) {
+    for (int8_t subIdx = -CALC.radius; subIdx <= CALC.radius; ++subIdx) {
 
         const uint8_t idx = centerIdx + subIdx;
         const float m     = intensities[idx];
-        const float w     = calc.weight(subIdx);
+        const float w     = CALC.weight(subIdx);
 
         sum  += m * w;
         sumW += m * w * idx;
     }
 
-    return optoIdxToLinePos(sumW / sum);
+    return sumW / sum;
 }
+
+template <typename Geometry>
+float BasicLinePosCalculator<Geometry>::estimateMatchedFilter(const float * const intensities, const uint8_t centerIdx) {
+    static constexpr int32_t WINDOW_RADIUS = MatchedFilterKernel::RADIUS + 2;
+
+    // the sensors around the peak, the sensors beyond the panel edges are treated as white
+    float window[2 * WINDOW_RADIUS + 1];
+    for (int32_t i = 0; i < 2 * WINDOW_RADIUS + 1; ++i) {
+        const int32_t idx = centerIdx - WINDOW_RADIUS + i;
+        window[i] = idx >= 0 && idx < Geometry::NUM_SENSORS ? intensities[idx] : 0.0f;
+    }
+
+    // correlation at the 5 positions around the peak - fixed-length dot products, that the compiler can vectorize
+    float correlation[5];
+    for (uint8_t k = 0; k < 5; ++k) {
+        float sum = 0.0f;
+        for (uint8_t j = 0; j < MatchedFilterKernel::SIZE; ++j) {
+            sum += MATCHED_FILTER_KERNEL.weights[j] * window[k + j];
+        }
+        correlation[k] = sum;
+    }
+
+    // the maximum is searched next to the peak only, the outer correlation values are needed for the interpolation
+    const uint8_t maxIdx = static_cast<uint8_t>(std::max_element(&correlation[1], &correlation[4]) - correlation);
+    return centerIdx + maxIdx - 2 + interpolatePeak(correlation[maxIdx - 1], correlation[maxIdx], correlation[maxIdx + 1]);
+}
+
+template <typename Geometry>
+float BasicLinePosCalculator<Geometry>::estimatePeakFit(const float * const intensities, const uint8_t centerIdx) {
+    const uint8_t startIdx = max<uint8_t>(centerIdx, 1) - 1;
+    const uint8_t endIdx   = min<uint8_t>(centerIdx + 2, Geometry::NUM_SENSORS);
+    const uint8_t maxIdx   = static_cast<uint8_t>(std::max_element(&intensities[startIdx], &intensities[endIdx]) - intensities);
+
+    // a peak at the panel edge cannot be fitted
+    if (0 == maxIdx || Geometry::NUM_SENSORS - 1 == maxIdx) {
+        return maxIdx;
+    }
+
+    return maxIdx + interpolatePeak(intensities[maxIdx - 1], intensities[maxIdx], intensities[maxIdx + 1]);
+}
+
+template <typename Geometry>
+std::pair<uint8_t, uint8_t> BasicLinePosCalculator<Geometry>::lineSensorRange(const LinePosition& linePos) {
+    const uint8_t sensorIdx = micro::round(linePosToOptoPos(linePos.pos));
+    return {
+        max<uint8_t>(sensorIdx, cfg::WHITE_LEVEL_LINE_GROUP_RADIUS) - cfg::WHITE_LEVEL_LINE_GROUP_RADIUS,
+        min<uint8_t>(sensorIdx + cfg::WHITE_LEVEL_LINE_GROUP_RADIUS + 1, Geometry::NUM_SENSORS)
+    };
+}
+
+template <typename Geometry>
+typename BasicLinePosCalculator<Geometry>::lineSensors_t BasicLinePosCalculator<Geometry>::lineSensors(const LinePositions& linePositions) {
+    lineSensors_t isLine = {};
+    for (const LinePosition& linePos : linePositions) {
+        const std::pair<uint8_t, uint8_t> range = lineSensorRange(linePos);
+        std::fill(std::next(isLine.begin(), range.first), std::next(isLine.begin(), range.second), true);
+    }
+    return isLine;
+}
+
+template class BasicLinePosCalculator<PanelGeometry<32>>;
+template class BasicLinePosCalculator<PanelGeometry<48>>;
+template class BasicLinePosCalculator<PanelGeometry<64>>;
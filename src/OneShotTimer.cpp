@@ -0,0 +1,43 @@
+#include <OneShotTimer.hpp>
+
+using namespace micro;
+
+OneShotTimer::OneShotTimer(const micro::timer_t& timer)
+    : timer_(timer) {}
+
+uint32_t OneShotTimer::now() const {
+    TIM_HandleTypeDef * const htim = this->timer_.handle;
+    const uint32_t period = __HAL_TIM_GET_AUTORELOAD(htim) + 1;
+
+    uint32_t ms          = 0;
+    uint32_t cntr        = 0;
+    bool isUpdatePending = false;
+
+    // re-reads the counter if the millisecond tick has been incremented in the meantime
+    do {
+        ms              = HAL_GetTick();
+        cntr            = __HAL_TIM_GET_COUNTER(htim);
+        isUpdatePending = !!__HAL_TIM_GET_FLAG(htim, TIM_FLAG_UPDATE);
+    } while (ms != HAL_GetTick());
+
+    // the HAL handles the compare interrupt before the update interrupt, so inside the compare callback
+    // the tick of a counter overflow that has just happened is not yet incremented - the pending update flag shows the overflow
+    if (isUpdatePending && cntr < period / 2) {
+        ++ms;
+    }
+
+    return ms * 1000 + cntr;
+}
+
+void OneShotTimer::start(const microsecond_t delay) {
+    TIM_HandleTypeDef * const htim = this->timer_.handle;
+    const uint32_t period = __HAL_TIM_GET_AUTORELOAD(htim) + 1;
+
+    __HAL_TIM_SET_COMPARE(htim, TIM_CHANNEL_1, (__HAL_TIM_GET_COUNTER(htim) + static_cast<uint32_t>(delay.get())) % period);
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_CC1);
+    __HAL_TIM_ENABLE_IT(htim, TIM_IT_CC1);
+}
+
+void OneShotTimer::stop() {
+    __HAL_TIM_DISABLE_IT(this->timer_.handle, TIM_IT_CC1);
+}
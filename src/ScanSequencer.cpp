@@ -0,0 +1,122 @@
+#include <micro/math/numeric.hpp>
+
+#include <ScanSequencer.hpp>
+
+namespace {
+
+constexpr uint8_t SENSOR_POSITIONS[NUM_SCAN_GROUPS] = {
+    0, 8,  4, 12,
+    1, 9,  5, 13,
+    2, 10, 6, 14,
+    3, 11, 7, 15
+};
+
+template <uint8_t NUM_ADCS>
+struct selectorTable_t {
+    uint8_t selectors[NUM_SCAN_GROUPS][NUM_ADCS];
+};
+
+// The LEDs of the sensors of an ADC are driven by the opto LED driver of its pair (ADC 0 - driver 1, ADC 1 - driver 0, ...).
+// Groups 0-7 light up the sensors of the even ADCs, groups 8-15 the sensors of the odd ADCs, one channel in each.
+// For the 48-sensor panel:
+//     { 0,   1,   0,   1,   0,   1   },
+//     { 0,   2,   0,   2,   0,   2   },
+//     ...
+//     { 1,   0,   1,   0,   1,   0   },
+//     ...
+//     { 128, 0,   128, 0,   128, 0   }
+template <uint8_t NUM_ADCS>
+constexpr selectorTable_t<NUM_ADCS> makeSelectorTable() {
+    selectorTable_t<NUM_ADCS> table = {};
+    for (uint8_t group = 0; group < NUM_SCAN_GROUPS; ++group) {
+        for (uint8_t driverIdx = 0; driverIdx < NUM_ADCS; ++driverIdx) {
+            const bool isEvenAdcGroup = group < 8;
+            const bool isOddDriver    = driverIdx % 2;
+            table.selectors[group][driverIdx] = isEvenAdcGroup == isOddDriver ? 1 << (group % 8) : 0;
+        }
+    }
+    return table;
+}
+
+template <uint8_t NUM_ADCS>
+constexpr selectorTable_t<NUM_ADCS> SENSOR_SELECTORS = makeSelectorTable<NUM_ADCS>();
+
+// Control byte: | START | SEL2 | SEL1 | SEL0 | UNI/BIP | SGL/DIF | PD1 | PD0 |
+// Select bits (according to the datasheet):
+//      SEL2    -   channel's 1st bit (LSB)
+//      SEL1    -   channel's 3rd bit
+//      SEL0    -   channel's 2nd bit
+//
+// @see MAX1110CAP+ datasheet for details
+constexpr uint8_t adcControlByte(const uint8_t channel) {
+    return 0b10001111 | ((channel & 0b00000001) << 6) | ((channel & 0b00000010) << 3) | ((channel & 0b00000100) << 3);
+}
+
+// The whole transmit buffer is stored for each channel, so that the transfers can be started directly from the table.
+// The conversion is repeated MAX_ADC_SAMPLES times, an oversampled read transfers the first numSamples conversions in one burst.
+constexpr uint8_t ADC_CONTROL[8][ADC_BUFFER_SIZE * MAX_ADC_SAMPLES] = {
+    { adcControlByte(0), 0, 0, adcControlByte(0), 0, 0, adcControlByte(0), 0, 0, adcControlByte(0), 0, 0 },
+    { adcControlByte(1), 0, 0, adcControlByte(1), 0, 0, adcControlByte(1), 0, 0, adcControlByte(1), 0, 0 },
+    { adcControlByte(2), 0, 0, adcControlByte(2), 0, 0, adcControlByte(2), 0, 0, adcControlByte(2), 0, 0 },
+    { adcControlByte(3), 0, 0, adcControlByte(3), 0, 0, adcControlByte(3), 0, 0, adcControlByte(3), 0, 0 },
+    { adcControlByte(4), 0, 0, adcControlByte(4), 0, 0, adcControlByte(4), 0, 0, adcControlByte(4), 0, 0 },
+    { adcControlByte(5), 0, 0, adcControlByte(5), 0, 0, adcControlByte(5), 0, 0, adcControlByte(5), 0, 0 },
+    { adcControlByte(6), 0, 0, adcControlByte(6), 0, 0, adcControlByte(6), 0, 0, adcControlByte(6), 0, 0 },
+    { adcControlByte(7), 0, 0, adcControlByte(7), 0, 0, adcControlByte(7), 0, 0, adcControlByte(7), 0, 0 }
+};
+
+} // namespace
+
+template <typename Geometry>
+void BasicScanTable<Geometry>::build(const sensorMask_t& sensors, const uint8_t numSamples) {
+    this->transactions_.clear();
+    this->numSamples_ = micro::clamp<uint8_t>(numSamples, 1, MAX_ADC_SAMPLES);
+
+    for (uint8_t i = 0; i < NUM_SCAN_GROUPS; ++i) {
+        const uint8_t optoIdx = SENSOR_POSITIONS[i];
+        const uint32_t groupStartIdx = this->transactions_.size();
+
+        for (uint8_t adcIdx = optoIdx / 8; adcIdx < Geometry::NUM_ADCS; adcIdx += 2) {
+            const uint8_t absPos = adcIdx * 8 + (optoIdx % 8);
+
+            if (sensors.test(absPos)) {
+                if (groupStartIdx == this->transactions_.size()) {
+                    this->transactions_.push_back({ transaction_t::SELECT, optoIdx, 0, 0 });
+                }
+                this->transactions_.push_back({ transaction_t::READ, optoIdx, adcIdx, absPos });
+            }
+        }
+    }
+}
+
+template <typename Geometry>
+void BasicScanTable<Geometry>::buildDark(const sensorMask_t& sensors) {
+    this->transactions_.clear();
+    this->numSamples_ = 1;
+
+    // no selector is shifted, so the LEDs are never turned on
+    for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+        if (sensors.test(i)) {
+            this->transactions_.push_back({ transaction_t::READ, 0, static_cast<uint8_t>(i / 8), i });
+        }
+    }
+}
+
+template <typename Geometry>
+const uint8_t* BasicScanTable<Geometry>::selector(const uint8_t group) {
+    return SENSOR_SELECTORS<Geometry::NUM_ADCS>.selectors[group];
+}
+
+template <typename Geometry>
+const uint8_t* BasicScanTable<Geometry>::adcControl(const uint8_t sensorIdx) {
+    return ADC_CONTROL[sensorIdx % 8];
+}
+
+template <typename Geometry>
+uint8_t BasicScanTable<Geometry>::adcValue(const uint8_t * const rxBuffer) {
+    return (rxBuffer[1] << 2) | (rxBuffer[2] >> 6); // ADC value format: 00000000 00XXXXXX XX000000
+}
+
+template class BasicScanTable<PanelGeometry<32>>;
+template class BasicScanTable<PanelGeometry<48>>;
+template class BasicScanTable<PanelGeometry<64>>;
@@ -0,0 +1,57 @@
+#include <micro/math/numeric.hpp>
+
+#include <LinePosCalculator.hpp>
+#include <SensorControl.hpp>
+
+using namespace micro;
+
+SensorMask getScanMask(const SensorControlData& sensorControl) {
+    SensorMask mask;
+
+    if (!sensorControl.fullScanRequired && sensorControl.scanRangeRadius > 0 && !sensorControl.scanRangeCenters.empty()) {
+        for (const uint8_t center : sensorControl.scanRangeCenters) {
+            const uint8_t startIdx = micro::max(center, sensorControl.scanRangeRadius) - sensorControl.scanRangeRadius;
+            const uint8_t endIdx   = micro::min<uint8_t>(center + sensorControl.scanRangeRadius, cfg::NUM_SENSORS - 1);
+
+            for (uint8_t i = startIdx; i <= endIdx; ++i) {
+                mask.set(i);
+            }
+        }
+    } else {
+        mask.set();
+    }
+
+    return mask;
+}
+
+uint8_t getNumSamples(const m_per_sec_t speed) {
+    const m_per_sec_t absSpeed = abs(speed);
+    return absSpeed < m_per_sec_t(1.0f) ? 4 : absSpeed < m_per_sec_t(2.0f) ? 2 : 1;
+}
+
+void updateIndicatorLeds(Leds& OUT leds, const Lines& lines) {
+    static constexpr uint8_t LED_RADIUS = 1;
+
+    leds.fill(false);
+
+    for (const Line& l : lines) {
+        const uint8_t centerIdx = static_cast<uint8_t>(round(LinePosCalculator::linePosToOptoPos(l.pos)));
+
+        const uint8_t startIdx = max<uint8_t>(centerIdx, LED_RADIUS) - LED_RADIUS;
+        const uint8_t endIdx = min<uint8_t>(centerIdx + LED_RADIUS + 1, cfg::NUM_SENSORS);
+
+        for (uint8_t i = startIdx; i < endIdx; ++i) {
+            leds[i] = true;
+        }
+    }
+}
+
+void updateScanRanges(SensorControlData& OUT sensorControl, const Lines& lines) {
+    // each tracked line gets its own scan range, so that separate lines do not need one wide range covering all of them
+    if (lines.size()) {
+        sensorControl.scanRangeCenters.clear();
+        for (const Line& l : lines) {
+            sensorControl.scanRangeCenters.push_back(round(LinePosCalculator::linePosToOptoPos(l.pos)));
+        }
+    }
+}
@@ -3,52 +3,27 @@
 #include <cfg_sensor.hpp>
 #include <SensorHandler.hpp>
 
-#include <utility>
-
 using namespace micro;
 
-namespace {
-
-constexpr uint8_t SENSOR_POSITIONS[16] = {
-    0, 8,  4, 12,
-    1, 9,  5, 13,
-    2, 10, 6, 14,
-    3, 11, 7, 15
-};
-
-constexpr uint8_t SENSOR_SELECTORS[16][cfg::NUM_SENSORS / 8] = {
-    { 0,   1,   0,   1,   0,   1   },
-    { 0,   2,   0,   2,   0,   2   },
-    { 0,   4,   0,   4,   0,   4   },
-    { 0,   8,   0,   8,   0,   8   },
-    { 0,   16,  0,   16,  0,   16  },
-    { 0,   32,  0,   32,  0,   32  },
-    { 0,   64,  0,   64,  0,   64  },
-    { 0,   128, 0,   128, 0,   128 },
-    { 1,   0,   1,   0,   1,   0   },
-    { 2,   0,   2,   0,   2,   0   },
-    { 4,   0,   4,   0,   4,   0   },
-    { 8,   0,   8,   0,   8,   0   },
-    { 16,  0,   16,  0,   16,  0   },
-    { 32,  0,   32,  0,   32,  0   },
-    { 64,  0,   64,  0,   64,  0   },
-    { 128, 0,   128, 0,   128, 0   }
-};
-
-} // namespace
-
 SensorHandler::SensorHandler(const spi_t& spi,
+    const micro::timer_t& settleTimer,
     const micro::vec<micro::gpio_t, cfg::NUM_SENSORS / 8>& adcEnPins,
     const micro::gpio_t& LE_opto,
     const micro::gpio_t& OE_opto,
     const micro::gpio_t& LE_ind,
     const micro::gpio_t& OE_ind)
-    : spi_(spi)
+    : sequencer_(*this)
+    , ambientLightPeriod_(0)
+    , ambientLightCntr_(0)
+    , spi_(spi)
+    , settleTimer_(settleTimer)
     , adcEnPins_(adcEnPins)
     , LE_opto_(LE_opto)
     , OE_opto_(OE_opto)
     , LE_ind_(LE_ind)
-    , OE_ind_(OE_ind) {}
+    , OE_ind_(OE_ind) {
+    this->ambientLight_.fill(0);
+}
 
 void SensorHandler::initialize() {
     gpio_write(this->LE_opto_, gpioPinState_t::RESET);
@@ -62,31 +37,36 @@ void SensorHandler::initialize() {
     }
 }
 
-void SensorHandler::readSensors(Measurements& OUT measurements, const std::pair<uint8_t, uint8_t>& scanRange) {
-
-    for (uint8_t i = 0; i < 16; ++i) {
-        const uint8_t optoIdx = SENSOR_POSITIONS[i];
-        this->exchangeData(SENSOR_SELECTORS[optoIdx], nullptr, cfg::NUM_SENSORS / 8);
+void SensorHandler::readSensors(Measurements& OUT measurements, const SensorMask& sensors, const uint8_t numSamples) {
 
-        gpio_write(this->LE_opto_, gpioPinState_t::SET);
-        gpio_write(this->LE_opto_, gpioPinState_t::RESET);
-        gpio_write(this->OE_opto_, gpioPinState_t::RESET);
-
-        for (volatile uint32_t t = 0; t < 800; ++t) {} // waits between the LED light-up and the ADC read
-
-        for (uint8_t adcIdx = optoIdx / 8; adcIdx < cfg::NUM_SENSORS / 8; adcIdx += 2) {
-            const uint8_t absPos = adcIdx * 8 + (optoIdx % 8);
+    if (sensors != this->scannedSensors_) {
+        this->scanTable_.build(sensors, numSamples);
+        this->darkTable_.buildDark(sensors);
+        this->scannedSensors_ = sensors;
+        if ((sensors & ~this->ambientSensors_).any()) {
+            this->ambientLightCntr_ = 0; // the ambient light of the newly scanned sensors is unknown
+        }
+    } else if (numSamples != this->scanTable_.numSamples()) {
+        this->scanTable_.build(sensors, numSamples);
+    }
 
-            if (micro::isBtw(absPos, scanRange.first, scanRange.second)) {
-                const gpio_t& adcEnPin = this->adcEnPins_[adcIdx];
+    if (this->scanTable_.transactions().empty()) {
+        return;
+    }
 
-                gpio_write(adcEnPin, gpioPinState_t::RESET);
-                measurements[absPos] = this->readAdc(optoIdx);
-                gpio_write(adcEnPin, gpioPinState_t::SET);
+    if (this->ambientLightPeriod_ > 0) {
+        // the LEDs have been off since the end of the previous frame, so the dark frame needs no settle time
+        if (0 == this->ambientLightCntr_) {
+            if (!this->runScan(this->darkTable_, this->ambientLight_)) {
+                return;
             }
+            this->ambientSensors_ |= sensors;
         }
+        this->ambientLightCntr_ = (this->ambientLightCntr_ + 1) % this->ambientLightPeriod_;
+    }
 
-        gpio_write(this->OE_opto_, gpioPinState_t::SET);
+    if (this->runScan(this->scanTable_, measurements) && this->ambientLightPeriod_ > 0) {
+        removeAmbientLight(measurements, this->ambientLight_);
     }
 }
 
@@ -108,22 +88,50 @@ void SensorHandler::writeLeds(const Leds& leds) {
 }
 
 void SensorHandler::onTxFinished() {
-    this->semaphore_.give();
+    if (!this->sequencer_.isBusy() || this->sequencer_.onTransferFinished()) {
+        this->semaphore_.give();
+    }
+}
+
+void SensorHandler::onSettleTimerElapsed() {
+    this->settleTimer_.stop();
+    this->sequencer_.onTimerElapsed();
+}
+
+void SensorHandler::exchange(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size) {
+    micro::spi_exchange(this->spi_, txBuf, rxBuf, size);
+}
+
+void SensorHandler::latchOpto() {
+    gpio_write(this->LE_opto_, gpioPinState_t::SET);
+    gpio_write(this->LE_opto_, gpioPinState_t::RESET);
+}
+
+void SensorHandler::enableOpto(const bool enabled) {
+    gpio_write(this->OE_opto_, enabled ? gpioPinState_t::RESET : gpioPinState_t::SET);
 }
 
-uint8_t SensorHandler::readAdc(const uint8_t channel) {
-    uint8_t adcBuffer[3] = { 0, 0, 0 };
-
-    // Control byte: | START | SEL2 | SEL1 | SEL0 | UNI/BIP | SGL/DIF | PD1 | PD0 |
-    // Select bits (according to the datasheet):
-    //      SEL2    -   channel's 1st bit (LSB)
-    //      SEL1    -   channel's 3rd bit
-    //      SEL0    -   channel's 2nd bit
-    //
-    // @see MAX1110CAP+ datasheet for details
-    adcBuffer[0] =  0b10001111 | ((channel & 0b00000001) << 6) | ((channel & 0b00000010) << 3) | ((channel & 0b00000100) << 3);
-    this->exchangeData(adcBuffer, adcBuffer, ARRAY_SIZE(adcBuffer));
-    return (adcBuffer[1] << 2) | (adcBuffer[2] >> 6); // ADC value format: 00000000 00XXXXXX XX000000
+void SensorHandler::selectAdc(const uint8_t adcIdx, const bool selected) {
+    gpio_write(this->adcEnPins_[adcIdx], selected ? gpioPinState_t::RESET : gpioPinState_t::SET);
+}
+
+uint32_t SensorHandler::now() const {
+    return this->settleTimer_.now();
+}
+
+void SensorHandler::startTimer(const microsecond_t delay) {
+    this->settleTimer_.start(delay);
+}
+
+bool SensorHandler::runScan(const ScanTable& table, Measurements& OUT measurements) {
+    // the whole frame is executed from the transfer complete callbacks, the task is only woken up when the frame is ready
+    this->sequencer_.start(table, measurements);
+    if (!this->semaphore_.take(millisecond_t(10))) {
+        this->settleTimer_.stop();
+        this->sequencer_.abort();
+        return false;
+    }
+    return true;
 }
 
 void SensorHandler::exchangeData(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size) {
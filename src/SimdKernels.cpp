@@ -0,0 +1,295 @@
+#include <SimdKernels.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if SIMD_BACKEND_ARM
+#include <stm32f4xx.h>
+#endif
+
+#if SIMD_BACKEND_SSE
+#include <emmintrin.h>
+#endif
+
+namespace simd {
+
+namespace {
+
+constexpr uint32_t WINDOW_RADIUS = 3;
+
+// Selects the 3rd smallest value of the window.
+// The 3 smallest values are kept sorted in registers and each value is inserted with min/max operations only,
+// so the selection is branch-free and gives exactly the same element as sorting the window.
+float thirdSmallest(const float *begin, const float * const end) {
+    float a = std::numeric_limits<float>::infinity();
+    float b = a;
+    float c = a;
+
+    for (; begin != end; ++begin) {
+        const float x = *begin;
+        c = std::min(c, std::max(b, x));
+        b = std::min(b, std::max(a, x));
+        a = std::min(a, x);
+    }
+
+    return c;
+}
+
+// Selects the 3rd smallest value of the windows of the values in [begin, end).
+void selectThirdSmallest(const float * const values, float * const OUT result, const uint32_t begin, const uint32_t end, const uint32_t size) {
+    for (uint32_t i = begin; i < end; ++i) {
+        const uint32_t startIdx = std::max(i, WINDOW_RADIUS) - WINDOW_RADIUS;
+        const uint32_t endIdx   = std::min(i + WINDOW_RADIUS + 1, size);
+        result[i] = thirdSmallest(&values[startIdx], &values[endIdx]);
+    }
+}
+
+} // namespace
+
+namespace scalar {
+
+void normalize(const uint8_t * const values, const uint8_t * const offsets, const float * const scales, float * const OUT result, const uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        result[i] = values[i] > offsets[i] ? (values[i] - offsets[i]) * scales[i] : 0.0f;
+    }
+}
+
+void accumulate(uint16_t * const sums, const uint8_t * const values, const uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        sums[i] += values[i];
+    }
+}
+
+float sum(const float * const values, const uint32_t size) {
+    float result = 0.0f;
+    for (uint32_t i = 0; i < size; ++i) {
+        result += values[i];
+    }
+    return result;
+}
+
+void filter3(const float * const values, const float edgeWeight, const float sumWeight, float * const OUT result, const uint32_t size) {
+    for (uint32_t i = 0; i + 2 < size; ++i) {
+        result[i] = (edgeWeight * values[i] + values[i + 1] + edgeWeight * values[i + 2]) / sumWeight;
+    }
+}
+
+void thirdSmallest7(const float * const values, float * const OUT result, const uint32_t size) {
+    selectThirdSmallest(values, result, 0, size, size);
+}
+
+} // namespace scalar
+
+#if SIMD_HAS_ARM
+
+namespace arm {
+
+namespace {
+
+#if SIMD_BACKEND_ARM
+
+// the used DSP instructions map to the CMSIS intrinsics on the target
+
+uint32_t emu_uqsub8(const uint32_t a, const uint32_t b) {
+    return __UQSUB8(a, b);
+}
+
+uint32_t emu_uadd16(const uint32_t a, const uint32_t b) {
+    return __UADD16(a, b);
+}
+
+uint32_t emu_uxtb16(const uint32_t x) {
+    return __UXTB16(x);
+}
+
+uint32_t emu_ror(const uint32_t x, const uint32_t n) {
+    return __ROR(x, n);
+}
+
+// the shift is an immediate operand of the instruction
+template <uint32_t shift>
+uint32_t emu_pkhbt(const uint32_t a, const uint32_t b) {
+    return __PKHBT(a, b, shift);
+}
+
+template <uint32_t shift>
+uint32_t emu_pkhtb(const uint32_t a, const uint32_t b) {
+    return __PKHTB(a, b, shift);
+}
+
+#else // !SIMD_BACKEND_ARM
+
+// host emulation of the used DSP instructions, bit-exact to the CMSIS intrinsics
+
+uint32_t emu_uqsub8(const uint32_t a, const uint32_t b) {
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        const uint32_t x = (a >> shift) & 0xff, y = (b >> shift) & 0xff;
+        result |= (x > y ? x - y : 0) << shift;
+    }
+    return result;
+}
+
+uint32_t emu_uadd16(const uint32_t a, const uint32_t b) {
+    return ((a + b) & 0x0000ffff) | (((a >> 16) + (b >> 16)) << 16);
+}
+
+uint32_t emu_uxtb16(const uint32_t x) {
+    return x & 0x00ff00ff;
+}
+
+uint32_t emu_ror(const uint32_t x, const uint32_t n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+template <uint32_t shift>
+uint32_t emu_pkhbt(const uint32_t a, const uint32_t b) {
+    return (a & 0x0000ffff) | ((b << shift) & 0xffff0000);
+}
+
+template <uint32_t shift>
+uint32_t emu_pkhtb(const uint32_t a, const uint32_t b) {
+    return (a & 0xffff0000) | (static_cast<uint32_t>(static_cast<int32_t>(b) >> shift) & 0x0000ffff);
+}
+
+#endif // !SIMD_BACKEND_ARM
+
+uint32_t load32(const void * const data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void store32(void * const data, const uint32_t value) {
+    memcpy(data, &value, sizeof(value));
+}
+
+} // namespace
+
+void normalize(const uint8_t * const values, const uint8_t * const offsets, const float * const scales, float * const OUT result, const uint32_t size) {
+    uint32_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        // saturating subtraction of 4 values at once, no compare and branch per value
+        const uint32_t diff = emu_uqsub8(load32(&values[i]), load32(&offsets[i]));
+        result[i]     = (diff & 0xff) * scales[i];
+        result[i + 1] = ((diff >> 8) & 0xff) * scales[i + 1];
+        result[i + 2] = ((diff >> 16) & 0xff) * scales[i + 2];
+        result[i + 3] = (diff >> 24) * scales[i + 3];
+    }
+    scalar::normalize(&values[i], &offsets[i], &scales[i], &result[i], size - i);
+}
+
+void accumulate(uint16_t * const sums, const uint8_t * const values, const uint32_t size) {
+    uint32_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const uint32_t bytes = load32(&values[i]);
+        const uint32_t even  = emu_uxtb16(bytes);               // values 0 and 2 in the two halfwords
+        const uint32_t odd   = emu_uxtb16(emu_ror(bytes, 8));   // values 1 and 3 in the two halfwords
+        store32(&sums[i],     emu_uadd16(load32(&sums[i]),     emu_pkhbt<16>(even, odd)));
+        store32(&sums[i + 2], emu_uadd16(load32(&sums[i + 2]), emu_pkhtb<16>(odd, even)));
+    }
+    scalar::accumulate(&sums[i], &values[i], size - i);
+}
+
+} // namespace arm
+
+#endif
+
+#if SIMD_BACKEND_SSE
+
+namespace sse {
+
+void normalize(const uint8_t * const values, const uint8_t * const offsets, const float * const scales, float * const OUT result, const uint32_t size) {
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i diff = _mm_subs_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&values[i])),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(&offsets[i])));
+        const __m128i diff16[2] = { _mm_unpacklo_epi8(diff, zero), _mm_unpackhi_epi8(diff, zero) };
+
+        for (uint32_t j = 0; j < 4; ++j) {
+            const __m128i diff32 = j % 2 ? _mm_unpackhi_epi16(diff16[j / 2], zero) : _mm_unpacklo_epi16(diff16[j / 2], zero);
+            _mm_storeu_ps(&result[i + 4 * j], _mm_mul_ps(_mm_cvtepi32_ps(diff32), _mm_loadu_ps(&scales[i + 4 * j])));
+        }
+    }
+    scalar::normalize(&values[i], &offsets[i], &scales[i], &result[i], size - i);
+}
+
+void accumulate(uint16_t * const sums, const uint8_t * const values, const uint32_t size) {
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&values[i]));
+        __m128i * const lo = reinterpret_cast<__m128i*>(&sums[i]);
+        __m128i * const hi = reinterpret_cast<__m128i*>(&sums[i + 8]);
+        _mm_storeu_si128(lo, _mm_add_epi16(_mm_loadu_si128(lo), _mm_unpacklo_epi8(bytes, zero)));
+        _mm_storeu_si128(hi, _mm_add_epi16(_mm_loadu_si128(hi), _mm_unpackhi_epi8(bytes, zero)));
+    }
+    scalar::accumulate(&sums[i], &values[i], size - i);
+}
+
+float sum(const float * const values, const uint32_t size) {
+    __m128 sums = _mm_setzero_ps();
+
+    uint32_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        sums = _mm_add_ps(sums, _mm_loadu_ps(&values[i]));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, sums);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar::sum(&values[i], size - i);
+}
+
+void filter3(const float * const values, const float edgeWeight, const float sumWeight, float * const OUT result, const uint32_t size) {
+    const __m128 edgeWeights = _mm_set1_ps(edgeWeight);
+    const __m128 sumWeights  = _mm_set1_ps(sumWeight);
+
+    uint32_t i = 0;
+    for (; i + 6 <= size; i += 4) {
+        const __m128 left   = _mm_mul_ps(edgeWeights, _mm_loadu_ps(&values[i]));
+        const __m128 right  = _mm_mul_ps(edgeWeights, _mm_loadu_ps(&values[i + 2]));
+        const __m128 center = _mm_loadu_ps(&values[i + 1]);
+        _mm_storeu_ps(&result[i], _mm_div_ps(_mm_add_ps(_mm_add_ps(left, center), right), sumWeights));
+    }
+    if (i + 2 < size) {
+        scalar::filter3(&values[i], edgeWeight, sumWeight, &result[i], size - i);
+    }
+}
+
+void thirdSmallest7(const float * const values, float * const OUT result, const uint32_t size) {
+    if (size < 2 * WINDOW_RADIUS + 4) {
+        scalar::thirdSmallest7(values, result, size);
+        return;
+    }
+
+    // the full windows are processed 4 at a time, with the same min/max network as the scalar selection
+    uint32_t i = WINDOW_RADIUS;
+    for (; i + 4 + WINDOW_RADIUS <= size; i += 4) {
+        __m128 a = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        __m128 b = a;
+        __m128 c = a;
+
+        for (uint32_t j = i - WINDOW_RADIUS; j <= i + WINDOW_RADIUS; ++j) {
+            const __m128 x = _mm_loadu_ps(&values[j]);
+            c = _mm_min_ps(c, _mm_max_ps(b, x));
+            b = _mm_min_ps(b, _mm_max_ps(a, x));
+            a = _mm_min_ps(a, x);
+        }
+
+        _mm_storeu_ps(&result[i], c);
+    }
+
+    // the truncated windows at the edges
+    selectThirdSmallest(values, result, 0, WINDOW_RADIUS, size);
+    selectThirdSmallest(values, result, i, size, size);
+}
+
+} // namespace sse
+
+#endif
+
+} // namespace simd
@@ -0,0 +1,13 @@
+#include <WhiteLevelStore.hpp>
+
+uint32_t crc32(const uint8_t * const data, const uint32_t size) {
+    // bitwise calculation, the record is too short for a lookup table to be worth its flash space
+    uint32_t crc = 0xffffffff;
+    for (uint32_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,53 @@
+#include <cfg_board.hpp>
+#include <FlashSector.hpp>
+
+#include <cstring>
+
+FlashSector::FlashSector(const uint32_t sector, const uint32_t address, const uint32_t size)
+    : sector_(sector)
+    , address_(address)
+    , size_(size) {}
+
+bool FlashSector::read(const uint32_t offset, void * const data, const uint32_t size) const {
+    if (offset + size > this->size_) {
+        return false;
+    }
+
+    // the flash is memory-mapped
+    memcpy(data, reinterpret_cast<const void*>(this->address_ + offset), size);
+    return true;
+}
+
+bool FlashSector::erase() {
+    FLASH_EraseInitTypeDef eraseInit;
+    eraseInit.TypeErase    = FLASH_TYPEERASE_SECTORS;
+    eraseInit.Sector       = this->sector_;
+    eraseInit.NbSectors    = 1;
+    eraseInit.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    uint32_t sectorError = 0;
+
+    HAL_FLASH_Unlock();
+    const HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&eraseInit, &sectorError);
+    HAL_FLASH_Lock();
+
+    return HAL_OK == status;
+}
+
+bool FlashSector::write(const uint32_t offset, const void * const data, const uint32_t size) {
+    if (offset + size > this->size_) {
+        return false;
+    }
+
+    const uint8_t * const bytes = static_cast<const uint8_t*>(data);
+    HAL_StatusTypeDef status = HAL_OK;
+
+    // byte programming needs no alignment, and the stored records are short
+    HAL_FLASH_Unlock();
+    for (uint32_t i = 0; i < size && HAL_OK == status; ++i) {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, this->address_ + offset + i, bytes[i]);
+    }
+    HAL_FLASH_Lock();
+
+    return HAL_OK == status;
+}
@@ -1,37 +1,50 @@
 #include <micro/panel/CanManager.hpp>
 #include <micro/panel/panelVersion.hpp>
 #include <micro/utils/algorithm.hpp>
-#include <micro/port/queue.hpp>
+#include <micro/port/semaphore.hpp>
 #include <micro/port/task.hpp>
+#include <micro/port/timer.hpp>
 #include <micro/utils/timer.hpp>
 
 #include <cfg_board.hpp>
+#include <FlashSector.hpp>
+#include <FrameStats.hpp>
 #include <LineFilter.hpp>
 #include <LinePatternCalculator.hpp>
 #include <LinePosCalculator.hpp>
+#include <LineTrackFrame.hpp>
+#include <OneShotTimer.hpp>
+#include <SensorControl.hpp>
 #include <SensorData.hpp>
-
-#include <numeric>
+#include <TripleBuffer.hpp>
+#include <WhiteLevelStore.hpp>
 
 using namespace micro;
 
-extern queue_t<Measurements, 1> measurementsQueue;
+extern TripleBuffer<Frame> frameBuffer;
+extern semaphore_t frameReadySemaphore;
 
 CanManager vehicleCanManager(can_Vehicle);
-queue_t<SensorControlData, 1> sensorControlDataQueue;
+TripleBuffer<SensorControlData> sensorControlBuffer;
+FrameStats frameStats; // not static, so that it can be watched from the debugger
 
 namespace {
 
+const OneShotTimer systemTimer(tim_System); // only the microsecond counter is used, the compare interrupt belongs to the sensor task
 LinePosCalculator linePosCalc(true);
 LineFilter lineFilter;
 LinePatternCalculator linePatternCalc;
 
+FlashSector calibFlash(FLASH_SECTOR_CALIB, FLASH_ADDRESS_CALIB, FLASH_SIZE_CALIB);
+WhiteLevelStore<FlashSector> whiteLevelStore(calibFlash);
+
+constexpr m_per_sec_t MAX_STANDSTILL_SPEED = m_per_sec_t(0.01f); // the speed is measured with noise, it is never exactly 0 while the car is moving
+
 linePatternDomain_t domain = linePatternDomain_t::Labyrinth;
 m_per_sec_t speed;
 meter_t distance;
 bool indicatorLedsEnabled = true;
 
-Measurements measurements;
 SensorControlData sensorControl;
 
 canFrame_t rxCanFrame;
@@ -56,34 +69,53 @@ const Leds& updateFailureLeds() {
 }
 
 void updateSensorControl(const Lines& lines, const bool isOk) {
-    static constexpr uint8_t LED_RADIUS = 1;
-
     if (isOk) {
-        sensorControl.leds.fill(false);
-
         if (indicatorLedsEnabled) {
-            for (const Line& l : lines) {
-                const uint8_t centerIdx = static_cast<uint8_t>(round(LinePosCalculator::linePosToOptoPos(l.pos)));
-
-                const uint8_t startIdx = max<uint8_t>(centerIdx, LED_RADIUS) - LED_RADIUS;
-                const uint8_t endIdx = min<uint8_t>(centerIdx + LED_RADIUS + 1, cfg::NUM_SENSORS);
-
-                for (uint8_t i = startIdx; i < endIdx; ++i) {
-                    sensorControl.leds[i] = true;
-                }
-            }
+            updateIndicatorLeds(sensorControl.leds, lines);
+        } else {
+            sensorControl.leds.fill(false);
         }
     } else {
         sensorControl.leds = updateFailureLeds();
     }
 
-    sensorControl.scanEnabled = true;
+    sensorControl.scanEnabled      = true;
+    sensorControl.fullScanRequired = !linePosCalc.isCalibrated(); // the white levels are calibrated from full frames only
+    sensorControl.numSamples       = getNumSamples(speed);
+    updateScanRanges(sensorControl, lines);
+}
+
+template <typename T>
+void sendLineTracks() {
+    static Timer sendTimer(T::period());
+    static uint8_t trackIdx = 0;
+
+    // the events are sent immediately, not to delay a new branch until the next periodic message
+    for (const LineTrackEvent& e : lineFilter.events()) {
+        vehicleCanManager.send<T>(vehicleCanSubscriberId, e.track, e.type);
+    }
 
-    if (lines.size()) {
-        const millimeter_t avgLinePos = std::accumulate(lines.begin(), lines.end(), millimeter_t(0),
-            [] (const millimeter_t& sum, const Line& line) { return sum + line.pos; }) / lines.size();
+    // one track is sent in each period, so that the tracks do not flood the bus
+    const LineTracks& tracks = lineFilter.tracks();
+    if (sendTimer.checkTimeout() && !tracks.empty()) {
+        trackIdx = (trackIdx + 1) % tracks.size();
+        vehicleCanManager.send<T>(vehicleCanSubscriberId, tracks[trackIdx], lineTrackEvent_t::None);
+    }
+}
 
-        sensorControl.scanRangeCenter = round(LinePosCalculator::linePosToOptoPos(avgLinePos));
+void loadWhiteLevels() {
+    Measurements whiteLevels;
+    if (whiteLevelStore.load(getPanelVersion(), whiteLevels)) {
+        linePosCalc.setWhiteLevels(whiteLevels);
+    }
+}
+
+void saveWhiteLevels() {
+    // the flash sector erase blocks the task, so the white levels are only saved while the car is standing
+    if (linePosCalc.hasUnsavedWhiteLevels() && abs(speed) < MAX_STANDSTILL_SPEED) {
+        // a failed save is not retried, the white levels are calibrated again after the next reset
+        whiteLevelStore.save(getPanelVersion(), linePosCalc.whiteLevels());
+        linePosCalc.onWhiteLevelsSaved();
     }
 }
 
@@ -100,7 +132,8 @@ void initializeVehicleCan() {
     const CanFrameIds rxFilter = vehicleCanFrameHandler.identifiers();
     const CanFrameIds txFilter = {
         PANEL_VERSION_FRONT == getPanelVersion() ? can::FrontLines::id() : can::RearLines::id(),
-        PANEL_VERSION_FRONT == getPanelVersion() ? can::FrontLinePattern::id() : can::RearLinePattern::id()
+        PANEL_VERSION_FRONT == getPanelVersion() ? can::FrontLinePattern::id() : can::RearLinePattern::id(),
+        PANEL_VERSION_FRONT == getPanelVersion() ? can::FrontLineTrack::id() : can::RearLineTrack::id()
     };
     vehicleCanSubscriberId = vehicleCanManager.registerSubscriber(rxFilter, txFilter);
 }
@@ -111,32 +144,64 @@ extern "C" void runLineCalcTask(void) {
 
     initializeVehicleCan();
 
-    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
-        measurements[i] = 0;
-    }
+    // the ambient light is removed from the measurements during the acquisition
+    linePosCalc.setOffsetFilterEnabled(0 == cfg::AMBIENT_LIGHT_PERIOD);
+    linePosCalc.setWhiteLevelAdaptationEnabled(cfg::WHITE_LEVEL_ADAPTATION_RATE > 0);
+    linePosCalc.setEstimator(linePosEstimator_t::Centroid);
+    lineFilter.setMultiHypothesisEnabled(cfg::LINE_FILTER_MULTI_HYPOTHESIS);
+    loadWhiteLevels();
+
+    bool isFirstFrame = true;
+    uint32_t prevScanStartTick = 0;
 
     while (true) {
-        measurementsQueue.receive(measurements);
+        frameReadySemaphore.take(millisecond_t(100));
+        if (!frameBuffer.read()) {
+            continue;
+        }
+
+        // the buffer is owned by this task until the next read, no copy is needed
+        const Frame& frame = frameBuffer.readBuffer();
+        frameStats.begin(frame, systemTimer.now());
+
+        const LinePositions linePositions = linePosCalc.calculate(frame.measurements, frame.scanMask);
+        frameStats.stamp(frameStage_t::LinePos, systemTimer.now());
+
+        // the odometry is received less often than the frames, so the distance between the frames is integrated from the speed
+        // the frame time is calculated from the integer timestamps, the float system time would lose precision over the uptime
+        const microsecond_t frameTime = isFirstFrame ? microsecond_t(0) : microsecond_t(static_cast<float>(frame.scanStartTick - prevScanStartTick));
+        const millimeter_t frameDistance = speed * frameTime;
+        prevScanStartTick = frame.scanStartTick;
+        isFirstFrame = false;
+
+        const Lines lines = lineFilter.update(linePositions, frameDistance);
+        frameStats.stamp(frameStage_t::LineFilter, systemTimer.now());
 
-        const LinePositions linePositions = linePosCalc.calculate(measurements);
-        const Lines lines = lineFilter.update(linePositions);
         linePatternCalc.update(domain, lines, distance, PANEL_VERSION_FRONT == getPanelVersion() ? sgn(speed) : -sgn(speed));
+        frameStats.stamp(frameStage_t::LinePattern, systemTimer.now());
 
         if (PANEL_VERSION_FRONT == getPanelVersion()) {
             vehicleCanManager.periodicSend<can::FrontLines>(vehicleCanSubscriberId, lines);
             vehicleCanManager.periodicSend<can::FrontLinePattern>(vehicleCanSubscriberId, linePatternCalc.pattern());
+            sendLineTracks<can::FrontLineTrack>();
         } else if (PANEL_VERSION_REAR == getPanelVersion()) {
             vehicleCanManager.periodicSend<can::RearLines>(vehicleCanSubscriberId, lines);
             vehicleCanManager.periodicSend<can::RearLinePattern>(vehicleCanSubscriberId, linePatternCalc.pattern());
+            sendLineTracks<can::RearLineTrack>();
         }
+        frameStats.stamp(frameStage_t::Send, systemTimer.now());
 
         while (vehicleCanManager.read(vehicleCanSubscriberId, rxCanFrame)) {
             vehicleCanFrameHandler.handleFrame(rxCanFrame);
         }
 
+        saveWhiteLevels();
+
         const bool isOk = !vehicleCanManager.hasTimedOut(vehicleCanSubscriberId);
         updateSensorControl(lines, isOk);
-        sensorControlDataQueue.send(sensorControl);
+
+        sensorControlBuffer.writeBuffer() = sensorControl;
+        sensorControlBuffer.publish();
     }
 }
 
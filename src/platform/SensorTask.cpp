@@ -1,56 +1,53 @@
-#include <micro/port/queue.hpp>
+#include <micro/port/semaphore.hpp>
 #include <micro/port/task.hpp>
-#include <micro/utils/log.hpp>
-#include <micro/utils/str_utils.hpp>
 
 #include <cfg_board.hpp>
+#include <SensorControl.hpp>
 #include <SensorHandler.hpp>
-
-#include <cstring>
+#include <TripleBuffer.hpp>
 
 using namespace micro;
 
-extern queue_t<SensorControlData, 1> sensorControlDataQueue;
-queue_t<Measurements, 1> measurementsQueue;
+extern TripleBuffer<SensorControlData> sensorControlBuffer;
+TripleBuffer<Frame> frameBuffer;
+semaphore_t frameReadySemaphore;
 
 namespace {
 
-SensorHandler sensorHandler(spi_Sensor, { gpio_SS_ADC0, gpio_SS_ADC1, gpio_SS_ADC2, gpio_SS_ADC3, gpio_SS_ADC4, gpio_SS_ADC5 },
+SensorHandler sensorHandler(spi_Sensor, tim_System, { gpio_SS_ADC0, gpio_SS_ADC1, gpio_SS_ADC2, gpio_SS_ADC3, gpio_SS_ADC4, gpio_SS_ADC5 },
     gpio_LE_OPTO, gpio_OE_OPTO, gpio_LE_IND, gpio_LE_IND);
 
-Measurements measurements;
-SensorControlData sensorControl;
-
-std::pair<uint8_t, uint8_t> getScanRange() {
-    std::pair<uint8_t, uint8_t> range = { 0, cfg::NUM_SENSORS - 1 };
-
-    if (sensorControl.scanRangeRadius > 0) {
-        range.first  = micro::max(sensorControl.scanRangeCenter, sensorControl.scanRangeRadius) - sensorControl.scanRangeRadius;
-        range.second = micro::min(sensorControl.scanRangeCenter + sensorControl.scanRangeRadius, cfg::NUM_SENSORS - 1);
-    }
-
-    return range;
-}
-
 } // namespace
 
 extern "C" void runSensorTask(void) {
 
     sensorHandler.initialize();
+    sensorHandler.setScanMode(scanMode_t::Pipelined);
+    sensorHandler.setAmbientLightPeriod(cfg::AMBIENT_LIGHT_PERIOD);
+    sensorHandler.setSampleFilter(sampleFilter_t::Mean);
+
+    uint32_t seq = 0;
 
     while (true) {
+        // acquisition does not wait for the line calculation, the newest control data is used if there is any
+        sensorControlBuffer.read();
+        const SensorControlData& sensorControl = sensorControlBuffer.readBuffer();
+
         sensorHandler.writeLeds(sensorControl.leds);
 
-        for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
-            measurements[i] = 0;
-        }
+        Frame& frame = frameBuffer.writeBuffer();
+        frame.seq = ++seq;
+        frame.scanMask = sensorControl.scanEnabled ? getScanMask(sensorControl) : SensorMask();
+        frame.measurements.fill(0);
 
+        frame.scanStartTick = sensorHandler.now();
         if (sensorControl.scanEnabled) {
-            sensorHandler.readSensors(measurements, getScanRange());
+            sensorHandler.readSensors(frame.measurements, frame.scanMask, sensorControl.numSamples);
         }
+        frame.scanEndTick = sensorHandler.now();
 
-        measurementsQueue.send(measurements);
-        sensorControlDataQueue.receive(sensorControl);
+        frameBuffer.publish();
+        frameReadySemaphore.give();
     }
 }
 
@@ -61,3 +58,7 @@ extern void spi_SensorTxCpltCallback() {
 extern void spi_SensorTxRxCpltCallback() {
     sensorHandler.onTxFinished();
 }
+
+extern void tim_SystemDelayElapsedCallback() {
+    sensorHandler.onSettleTimerElapsed();
+}
@@ -4,6 +4,7 @@
 
 extern void spi_SensorTxCpltCallback();
 extern void spi_SensorTxRxCpltCallback();
+extern void tim_SystemDelayElapsedCallback();
 extern void micro_Vehicle_Can_RxFifoMsgPendingCallback();
 
 extern "C" void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
@@ -18,6 +19,12 @@ extern "C" void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
     }
 }
 
+extern "C" void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
+    if (htim == tim_System.handle) {
+        tim_SystemDelayElapsedCallback();
+    }
+}
+
 extern "C" void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
     if (hcan == can_Vehicle.handle) {
         micro_Vehicle_Can_RxFifoMsgPendingCallback();
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <micro/utils/types.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Host-side model of a flash sector, backed by a file so that the content survives a restart.
+// Erasing sets all bits, programming can only clear bits - the same way as the internal flash.
+class FileFlash {
+public:
+    FileFlash(const std::string& path, const uint32_t size)
+        : path_(path)
+        , size_(size) {}
+
+    bool read(const uint32_t offset, void * const data, const uint32_t size) const {
+        if (offset + size > this->size_) {
+            return false;
+        }
+
+        const std::vector<uint8_t> content = this->load();
+        std::copy(&content[offset], &content[offset + size], static_cast<uint8_t*>(data));
+        return true;
+    }
+
+    bool erase() {
+        ++this->numErases;
+        return this->store(std::vector<uint8_t>(this->size_, 0xff));
+    }
+
+    bool write(const uint32_t offset, const void * const data, const uint32_t size) {
+        if (offset + size > this->size_) {
+            return false;
+        }
+
+        std::vector<uint8_t> content = this->load();
+        const uint8_t * const bytes = static_cast<const uint8_t*>(data);
+        for (uint32_t i = 0; i < size; ++i) {
+            content[offset + i] &= bytes[i];
+        }
+        return this->store(content);
+    }
+
+    uint32_t numErases = 0;
+
+private:
+    // a missing file is an erased sector
+    std::vector<uint8_t> load() const {
+        std::vector<uint8_t> content(this->size_, 0xff);
+        std::ifstream file(this->path_, std::ios::binary);
+        file.read(reinterpret_cast<char*>(content.data()), this->size_);
+        return content;
+    }
+
+    bool store(const std::vector<uint8_t>& content) {
+        std::ofstream file(this->path_, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(content.data()), content.size());
+        return file.good();
+    }
+
+    const std::string path_;
+    const uint32_t size_;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <micro/math/numeric.hpp>
+
+#include <ScanSequencer.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+// Host-side model of the sensor SPI bus: opto LED driver shift registers, ADCs and their chip-select lines.
+// Transfers and timers are completed by run() in place of the DMA and the timer interrupt, on a simulated clock.
+class MockSensorBus {
+public:
+    static constexpr uint32_t SPI_BYTE_TIME   = 6; // [us] 8 bits at 1.4 MHz
+    static constexpr uint32_t GPIO_WRITE_TIME = 1; // [us] pin write from the interrupt handler, together with its share of the interrupt entry
+
+    struct stats_t {
+        uint32_t transactions = 0;
+        uint32_t gpioWrites   = 0;
+        uint32_t wakeups      = 0;
+        uint32_t busyTime     = 0; // [us] time spent transferring data and writing the pins
+        uint32_t idleTime     = 0; // [us] time spent waiting for the timer
+    };
+
+    MockSensorBus() {
+        this->intensities.fill(0);
+        this->ambientLight.fill(0);
+        this->shiftRegister_.fill(0);
+        this->latched_.fill(0);
+    }
+
+    void exchange(const uint8_t *txBuf, uint8_t *rxBuf, const uint32_t size) {
+        ++this->stats.transactions;
+        this->isTransferPending_ = true;
+        this->transferTime_ = size * SPI_BYTE_TIME;
+        this->isSelectorShifted_ = this->selectedAdc_ < 0 && NUM_ADCS == size;
+
+        // an ADC burst holds one conversion for each control byte
+        if (this->selectedAdc_ >= 0 && rxBuf) {
+            for (uint32_t i = 0; i + ADC_BUFFER_SIZE <= size; i += ADC_BUFFER_SIZE) {
+                const uint8_t value = this->sample(this->selectedAdc_, txBuf[i]);
+                rxBuf[i]     = 0;
+                rxBuf[i + 1] = value >> 2;
+                rxBuf[i + 2] = (value & 0b11) << 6;
+            }
+        }
+
+        // every byte on the bus is clocked through the opto LED driver shift registers
+        for (uint32_t i = 0; i < size; ++i) {
+            std::rotate(this->shiftRegister_.begin(), std::next(this->shiftRegister_.begin()), this->shiftRegister_.end());
+            this->shiftRegister_[NUM_ADCS - 1] = txBuf[i];
+        }
+    }
+
+    // The selector must be the last data clocked into the shift registers before the latch,
+    // any ADC transfer in between would shift a corrupt pattern to the outputs.
+    void latchOpto() {
+        this->writeGpio();
+        if (!this->isSelectorShifted_) {
+            ++this->numInvalidLatches;
+        }
+        this->latched_   = this->shiftRegister_;
+        this->latchTime_ = this->time;
+    }
+
+    void enableOpto(const bool enabled) {
+        this->writeGpio();
+        if (enabled && !this->isOptoEnabled_) {
+            ++this->numOptoEnables;
+        }
+        this->isOptoEnabled_ = enabled;
+    }
+
+    void selectAdc(const uint8_t adcIdx, const bool selected) {
+        this->writeGpio();
+        this->selectedAdc_ = selected ? adcIdx : -1;
+    }
+
+    uint32_t now() const {
+        return this->time;
+    }
+
+    void startTimer(const micro::microsecond_t delay) {
+        this->isTimerRunning_ = true;
+        this->timerDeadline_  = this->time + static_cast<uint32_t>(delay.get());
+    }
+
+    // Executes a whole frame, completing each transfer and timer the same way their interrupts would.
+    template <typename Sequencer>
+    void run(Sequencer& sequencer, const ScanTable& table, Measurements& OUT measurements) {
+        sequencer.start(table, measurements);
+        while (this->isTransferPending_ || this->isTimerRunning_) {
+            if (this->isTransferPending_) {
+                this->isTransferPending_ = false;
+                this->time += this->transferTime_;
+                this->stats.busyTime += this->transferTime_;
+                if (sequencer.onTransferFinished()) {
+                    ++this->stats.wakeups;
+                }
+            } else {
+                this->isTimerRunning_ = false;
+                this->stats.idleTime += this->timerDeadline_ - this->time;
+                this->time = this->timerDeadline_;
+                sequencer.onTimerElapsed();
+            }
+        }
+    }
+
+    Measurements intensities;   // light reflected to each sensor when its LED is on
+    Measurements ambientLight;  // light reaching each sensor regardless of its LED
+    uint8_t noise = 0;          // amplitude of the uniform ADC noise added to each conversion
+    uint32_t time              = 0; // [us] simulated time
+    uint32_t numUnlitReads     = 0;
+    uint32_t numUnsettledReads = 0;
+    uint32_t numInvalidLatches = 0;
+    uint32_t numOptoEnables    = 0;
+    stats_t stats;
+
+private:
+    // the pin writes are executed by the CPU, they are not overlapped with anything
+    void writeGpio() {
+        ++this->stats.gpioWrites;
+        this->time += GPIO_WRITE_TIME;
+        this->stats.busyTime += GPIO_WRITE_TIME;
+    }
+
+    uint8_t sample(const uint8_t adcIdx, const uint8_t controlByte) {
+        const uint8_t channel = ((controlByte >> 6) & 0b001) | ((controlByte >> 3) & 0b110);
+        const bool isLit = this->isOptoEnabled_ && (this->latched_[adcIdx ^ 1] & (1 << channel));
+
+        if (!isLit) {
+            ++this->numUnlitReads;
+        } else if (this->time - this->latchTime_ < static_cast<uint32_t>(cfg::OPTO_SETTLE_TIME.get())) {
+            ++this->numUnsettledReads;
+        }
+
+        const uint8_t sensorIdx = adcIdx * 8 + channel;
+        const int32_t noise = this->noise > 0 ? static_cast<int32_t>(rand() % (2 * this->noise + 1)) - this->noise : 0;
+        return micro::clamp<int32_t>(this->ambientLight[sensorIdx] + (isLit ? this->intensities[sensorIdx] : 0) + noise, 0, 255);
+    }
+
+    std::array<uint8_t, NUM_ADCS> shiftRegister_;
+    std::array<uint8_t, NUM_ADCS> latched_;
+    bool isOptoEnabled_     = false;
+    int8_t selectedAdc_     = -1;
+    bool isTransferPending_ = false;
+    uint32_t transferTime_  = 0;
+    bool isTimerRunning_    = false;
+    uint32_t timerDeadline_ = 0;
+    uint32_t latchTime_     = 0;
+    bool isSelectorShifted_ = false;
+};
@@ -0,0 +1,81 @@
+#include <micro/test/utils.hpp>
+#include <FrameStats.hpp>
+
+using namespace micro;
+
+namespace {
+
+Frame makeFrame(const uint32_t seq, const uint32_t scanStartTick, const uint32_t scanEndTick) {
+    Frame frame;
+    frame.seq           = seq;
+    frame.scanStartTick = scanStartTick;
+    frame.scanEndTick   = scanEndTick;
+    return frame;
+}
+
+} // namespace
+
+TEST(FrameStats, stage_times) {
+    FrameStats stats;
+
+    stats.begin(makeFrame(1, 1000, 1400), 1450);
+    stats.stamp(frameStage_t::LinePos, 1500);
+    stats.stamp(frameStage_t::LineFilter, 1520);
+    stats.stamp(frameStage_t::LinePattern, 1600);
+    stats.stamp(frameStage_t::Send, 1610);
+
+    EXPECT_EQ(1, stats.numFrames());
+    EXPECT_EQ(0, stats.numDropped());
+    EXPECT_NEAR_UNIT(microsecond_t(400), stats.scanTime(), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(50), stats.waitTime(), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(500), stats.stageTime(frameStage_t::LinePos), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(520), stats.stageTime(frameStage_t::LineFilter), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(600), stats.stageTime(frameStage_t::LinePattern), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(610), stats.latency(), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(610), stats.maxLatency(), microsecond_t(0.1f));
+}
+
+TEST(FrameStats, max_latency) {
+    FrameStats stats;
+
+    stats.begin(makeFrame(1, 0, 400), 400);
+    stats.stamp(frameStage_t::Send, 900);
+
+    stats.begin(makeFrame(2, 500, 900), 900);
+    stats.stamp(frameStage_t::Send, 1200);
+
+    EXPECT_NEAR_UNIT(microsecond_t(700), stats.latency(), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(900), stats.maxLatency(), microsecond_t(0.1f));
+}
+
+TEST(FrameStats, dropped_frames) {
+    FrameStats stats;
+
+    stats.begin(makeFrame(1, 0, 0), 0);
+    stats.begin(makeFrame(2, 0, 0), 0);
+    EXPECT_EQ(0, stats.numDropped());
+
+    stats.begin(makeFrame(5, 0, 0), 0);
+    EXPECT_EQ(2, stats.numDropped());
+
+    stats.begin(makeFrame(6, 0, 0), 0);
+    EXPECT_EQ(2, stats.numDropped());
+    EXPECT_EQ(4, stats.numFrames());
+}
+
+TEST(FrameStats, long_uptime) {
+    FrameStats stats;
+
+    // ~71 minutes of uptime, the float system time would only resolve steps of 256 us here
+    const uint32_t start = 0xffffff00;
+
+    stats.begin(makeFrame(1, start, start + 400), start + 450);
+    stats.stamp(frameStage_t::LinePos, start + 500);
+    stats.stamp(frameStage_t::Send, start + 610); // the counter wraps around during the frame
+
+    EXPECT_NEAR_UNIT(microsecond_t(400), stats.scanTime(), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(50), stats.waitTime(), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(500), stats.stageTime(frameStage_t::LinePos), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(610), stats.latency(), microsecond_t(0.1f));
+    EXPECT_NEAR_UNIT(microsecond_t(610), stats.maxLatency(), microsecond_t(0.1f));
+}
@@ -3,7 +3,10 @@
 #include <LineFilter.hpp>
 
 #define PRINT_MEAS false
+#include <chrono>
 #include <cmath>
+#include <random>
+#include <vector>
 
 #if PRINT_MEAS
 #include <iomanip>
@@ -16,6 +19,12 @@ using namespace micro;
 namespace {
 
 constexpr uint32_t NUM_TESTS_PER_SCENARIO = 1;
+constexpr millimeter_t FRAME_DISTANCE = { 6 }; // 2 m/s at about 330 frames per second
+constexpr uint32_t CROSSING_LENGTH    = 600;     // mm, the lines of the crossing scenario cross each other in the middle
+
+// number of frames of the validation and the removal of a line detected with full probability
+const uint32_t NUM_VALIDATION_FRAMES = micro::round(cfg::LINE_VALIDATION_DISTANCE / FRAME_DISTANCE);
+const uint32_t NUM_REMOVAL_FRAMES    = micro::round(cfg::LINE_REMOVAL_DISTANCE / FRAME_DISTANCE);
 
 LinePositions addNoise(const LinePositions& linePositions) {
 
@@ -42,6 +51,55 @@ LinePositions move(const LinePositions& linePositions, const millimeter_t distan
     return result;
 }
 
+// Replays the same line with the given distances between the frames, and samples the tracked lines at every SAMPLE_DISTANCE.
+// The distance pattern is repeated until the end of the track, and the line is not detected in short sections of it.
+// The last frame at a sample point is sampled, so that the frames with no distance travelled are sampled as well.
+std::vector<Lines> replayTrack(const std::vector<uint32_t>& frameDistances) {
+
+    static constexpr uint32_t TRACK_LENGTH    = 1536; // mm
+    static constexpr uint32_t SAMPLE_DISTANCE = 24;   // mm
+
+    LineFilter lineFilter;
+    std::vector<Lines> samples;
+
+    uint32_t distance = 0;
+    for (uint32_t i = 0; distance < TRACK_LENGTH; ++i) {
+        const uint32_t frameDistance = frameDistances[i % frameDistances.size()];
+        distance += frameDistance;
+
+        LinePositions linePositions = { { millimeter_t(40 * std::sin(distance / 300.0f)), 1.0f } };
+        if (distance % 96 >= 80 && distance % 96 < 90) {
+            linePositions.clear();
+        }
+
+        const Lines lines = lineFilter.update(linePositions, millimeter_t(frameDistance));
+
+        if (distance > 0 && 0 == distance % SAMPLE_DISTANCE) {
+            samples.resize(distance / SAMPLE_DISTANCE);
+            samples.back() = lines;
+        }
+    }
+
+    return samples;
+}
+
+// Replays two lines crossing each other with the given slopes, both lines are detected as one while they are closer than MIN_LINE_DIST.
+// Returns the tracked lines of each frame.
+std::vector<Lines> replayCrossing(LineFilter& lineFilter, const float slope) {
+    std::vector<Lines> frames;
+
+    for (uint32_t distance = FRAME_DISTANCE.get(); distance <= CROSSING_LENGTH; distance += FRAME_DISTANCE.get()) {
+        const millimeter_t pos = millimeter_t(slope * (static_cast<float>(distance) - CROSSING_LENGTH / 2));
+        const LinePositions linePositions = abs(2 * pos) < cfg::MIN_LINE_DIST ?
+            LinePositions{ { millimeter_t(0), 1.0f } } :
+            LinePositions{ { -abs(pos), 1.0f }, { abs(pos), 1.0f } };
+
+        frames.push_back(lineFilter.update(linePositions, FRAME_DISTANCE));
+    }
+
+    return frames;
+}
+
 } // namespace
 
 TEST(LineFilter, one_line_few_detections) {
@@ -50,8 +108,8 @@ TEST(LineFilter, one_line_few_detections) {
     LineFilter lineFilter;
     Lines lines;
     
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS - 1; ++i) {
-        lines = lineFilter.update(linePositions);
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES - 1; ++i) {
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(0, lines.size());
@@ -63,8 +121,8 @@ TEST(LineFilter, one_line) {
     LineFilter lineFilter;
     Lines lines;
     
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS; ++i) {
-        lines = lineFilter.update(linePositions);
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(linePositions.size(), lines.size());
@@ -81,9 +139,9 @@ TEST(LineFilter, one_line_noise) {
     LineFilter lineFilter;
     Lines lines;
     
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS; ++i) {
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
         linePositions = addNoise(linePositions_base);
-        lines = lineFilter.update(linePositions);
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(linePositions.size(), lines.size());
@@ -101,9 +159,9 @@ TEST(LineFilter, one_line_noise_false_positives) {
     LineFilter lineFilter;
     Lines lines;
     
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS; ++i) {
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
         linePositions = addNoise(i == 0 ? linePositionsFalsePositives_base : linePositions_base);
-        lines = lineFilter.update(linePositions);
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(linePositions.size(), lines.size());
@@ -120,8 +178,8 @@ TEST(LineFilter, one_line_true_negatives) {
     LineFilter lineFilter;
     Lines lines;
     
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS; ++i) {
-        lines = lineFilter.update(linePositions);
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(linePositions.size(), lines.size());
@@ -130,8 +188,8 @@ TEST(LineFilter, one_line_true_negatives) {
         EXPECT_EQ(i + 1, lines[i].id);
     }
 
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS - 1; ++i) {
-        lines = lineFilter.update(linePositionsTrueNegatives);
+    for (uint32_t i = 0; i < NUM_REMOVAL_FRAMES - 1; ++i) {
+        lines = lineFilter.update(linePositionsTrueNegatives, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(linePositions.size(), lines.size());
@@ -140,7 +198,7 @@ TEST(LineFilter, one_line_true_negatives) {
         EXPECT_EQ(i + 1, lines[i].id);
     }
 
-    lines = lineFilter.update(linePositionsTrueNegatives);
+    lines = lineFilter.update(linePositionsTrueNegatives, FRAME_DISTANCE);
 
     EXPECT_EQ(0, lines.size());
 }
@@ -155,9 +213,9 @@ TEST(LineFilter, one_moving_line_true_negatives) {
     LineFilter lineFilter;
     Lines lines;
     
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS; ++i) {
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
         linePositions = move(linePositions, MOVE_DISTANCE);
-        lines = lineFilter.update(linePositions);
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(linePositions.size(), lines.size());
@@ -166,9 +224,9 @@ TEST(LineFilter, one_moving_line_true_negatives) {
         EXPECT_EQ(i + 1, lines[i].id);
     }
 
-    for (uint32_t i = 0; i < cfg::LINE_FILTER_HYSTERESIS - 1; ++i) {
+    for (uint32_t i = 0; i < NUM_REMOVAL_FRAMES - 1; ++i) {
         linePositions = move(linePositions, MOVE_DISTANCE);
-        lines = lineFilter.update(linePositionsTrueNegatives);
+        lines = lineFilter.update(linePositionsTrueNegatives, FRAME_DISTANCE);
     }
 
     EXPECT_EQ(linePositions.size(), lines.size());
@@ -178,7 +236,322 @@ TEST(LineFilter, one_moving_line_true_negatives) {
     }
 
     linePositions = move(linePositions, MOVE_DISTANCE);
-    lines = lineFilter.update(linePositionsTrueNegatives);
+    lines = lineFilter.update(linePositionsTrueNegatives, FRAME_DISTANCE);
 
     EXPECT_EQ(0, lines.size());
 }
+
+TEST(LineFilter, two_lines_optimal_assignment) {
+    LinePositions linePositions = { { millimeter_t(0), 1.0f }, { millimeter_t(30), 1.0f } };
+
+    LineFilter lineFilter;
+    Lines lines;
+
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
+    }
+    ASSERT_EQ(2, lines.size());
+
+    // the 2nd line is the closest to the 1st detection, but pairing them would leave the 1st line without a match
+    linePositions = { { millimeter_t(18), 1.0f }, { millimeter_t(45), 1.0f } };
+    lines = lineFilter.update(linePositions, FRAME_DISTANCE);
+
+    // both lines follow their detections, the filtered positions are only slightly behind them
+    ASSERT_EQ(linePositions.size(), lines.size());
+    for (uint32_t i = 0; i < lines.size(); ++i) {
+        EXPECT_NEAR_UNIT(linePositions[i].pos, lines[i].pos, millimeter_t(3));
+        EXPECT_EQ(i + 1, lines[i].id);
+    }
+}
+
+TEST(LineFilter, one_moving_line_noise) {
+
+    static constexpr millimeter_t MOVE_DISTANCE = { 2 };
+    static constexpr uint32_t NUM_FRAMES = 200;
+
+    const LinePositions linePositions_base = { { millimeter_t(-60), 1.0f } };
+
+    LineFilter lineFilter;
+    Lines lines;
+    millimeter_t sumDetectionError, sumFilteredError;
+
+    for (uint32_t i = 0; i < NUM_FRAMES; ++i) {
+        const LinePositions expected = move(linePositions_base, MOVE_DISTANCE * i);
+        const LinePositions linePositions = addNoise(expected);
+        lines = lineFilter.update(linePositions, FRAME_DISTANCE);
+
+        ASSERT_EQ(i + 1 >= NUM_VALIDATION_FRAMES ? 1 : 0, lines.size());
+        EXPECT_EQ(1, lines.size() ? lines[0].id : 1);
+
+        // the velocity needs a few frames to settle
+        if (i >= NUM_FRAMES / 2) {
+            sumDetectionError += abs(linePositions[0].pos - expected[0].pos);
+            sumFilteredError  += abs(lines[0].pos - expected[0].pos);
+        }
+    }
+
+    // the moving line is followed without lag, and the noise of the detections is reduced
+    EXPECT_LT(sumFilteredError, sumDetectionError);
+}
+
+TEST(LineFilter, frame_rate_invariance) {
+    const std::vector<Lines> reference = replayTrack({ 2 });
+
+    // different frame rates, stops (no distance travelled) and dropped frames (double distance),
+    // the stops of the last pattern are at the sample points, and every pattern has frames in the sections with no detection
+    for (const std::vector<uint32_t>& frameDistances : std::vector<std::vector<uint32_t>>{ { 4 }, { 8 }, { 2, 0, 0, 6 }, { 8, 0, 16 }, { 8, 16, 0 } }) {
+        const std::vector<Lines> samples = replayTrack(frameDistances);
+        ASSERT_EQ(reference.size(), samples.size());
+
+        // the line is validated after the same distance at every frame rate, the positions need a few samples to settle
+        for (uint32_t i = 0; i < samples.size(); ++i) {
+            ASSERT_EQ(1, reference[i].size());
+            ASSERT_EQ(1, samples[i].size());
+            EXPECT_EQ(reference[i][0].id, samples[i][0].id);
+            if (i >= 2) {
+                EXPECT_NEAR_UNIT(reference[i][0].pos, samples[i][0].pos, millimeter_t(0.01f));
+            }
+        }
+    }
+}
+
+TEST(LineFilter, validation_distance) {
+
+    // returns the number of frames needed to validate a line
+    const auto numValidationFrames = [] (const millimeter_t frameDistance, const float probability) {
+        const LinePositions linePositions = { { millimeter_t(0), probability } };
+        LineFilter lineFilter;
+        uint32_t numFrames = 1;
+        while (lineFilter.update(linePositions, frameDistance).empty()) {
+            ++numFrames;
+        }
+        return numFrames;
+    };
+
+    EXPECT_EQ(4, numValidationFrames(millimeter_t(6), 1.0f));
+
+    // a strong detection at high speed is validated sooner, a weak one needs more frames
+    EXPECT_EQ(2, numValidationFrames(millimeter_t(12), 1.0f));
+    EXPECT_EQ(4, numValidationFrames(millimeter_t(12), 0.5f));
+
+    // the frame limits apply at very high speed and at standstill
+    EXPECT_EQ(cfg::LINE_FILTER_MIN_FRAMES, numValidationFrames(millimeter_t(100), 1.0f));
+    EXPECT_EQ(cfg::LINE_FILTER_MAX_FRAMES, numValidationFrames(millimeter_t(0), 1.0f));
+
+    // the same distance is needed when reversing
+    EXPECT_EQ(4, numValidationFrames(millimeter_t(-6), 1.0f));
+}
+
+TEST(LineFilter, track_events) {
+    const LinePositions linePositions = { { millimeter_t(10), 1.0f } };
+
+    for (const bool isMultiHypothesisEnabled : { false, true }) {
+        LineFilter lineFilter;
+        lineFilter.setMultiHypothesisEnabled(isMultiHypothesisEnabled);
+
+        // the new line is reported in its first frame, its confidence grows until it is validated
+        float prevConfidence = 0.0f;
+        for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
+            const Lines lines = lineFilter.update(linePositions, FRAME_DISTANCE);
+            ASSERT_EQ(1, lineFilter.tracks().size());
+
+            const LineTrack& track = lineFilter.tracks()[0];
+            EXPECT_EQ(1, track.id);
+            EXPECT_EQ(i + 1, track.age);
+            EXPECT_EQ(0, track.numMissedFrames);
+            EXPECT_GT(track.confidence, prevConfidence);
+            EXPECT_LE(track.confidence, 1.0f);
+            prevConfidence = track.confidence;
+
+            if (0 == i) {
+                ASSERT_EQ(1, lineFilter.events().size());
+                EXPECT_EQ(lineTrackEvent_t::Born, lineFilter.events()[0].type);
+                EXPECT_EQ(1, lineFilter.events()[0].track.id);
+                EXPECT_EQ(0, lines.size());
+            } else if (NUM_VALIDATION_FRAMES - 1 == i) {
+                ASSERT_EQ(1, lineFilter.events().size());
+                EXPECT_EQ(lineTrackEvent_t::Validated, lineFilter.events()[0].type);
+                EXPECT_EQ(1, lines.size());
+            } else {
+                EXPECT_EQ(0, lineFilter.events().size());
+            }
+        }
+
+        // the missed line coasts on its prediction with decreasing confidence, until it is lost
+        for (uint32_t i = 0; i < NUM_REMOVAL_FRAMES; ++i) {
+            lineFilter.update(LinePositions(), FRAME_DISTANCE);
+
+            if (NUM_REMOVAL_FRAMES - 1 == i) {
+                // the lost line is reported with its state from the previous frame
+                EXPECT_EQ(0, lineFilter.tracks().size());
+                ASSERT_EQ(1, lineFilter.events().size());
+                EXPECT_EQ(lineTrackEvent_t::Lost, lineFilter.events()[0].type);
+                EXPECT_EQ(1, lineFilter.events()[0].track.id);
+                EXPECT_EQ(NUM_REMOVAL_FRAMES - 1, lineFilter.events()[0].track.numMissedFrames);
+            } else {
+                ASSERT_EQ(1, lineFilter.tracks().size());
+                EXPECT_EQ(i + 1, lineFilter.tracks()[0].numMissedFrames);
+                EXPECT_LT(lineFilter.tracks()[0].confidence, prevConfidence);
+                EXPECT_TRUE(lineFilter.tracks()[0].isValidated);
+                EXPECT_EQ(0, lineFilter.events().size());
+                prevConfidence = lineFilter.tracks()[0].confidence;
+            }
+        }
+    }
+}
+
+TEST(LineFilter, track_events_reused_id) {
+    LineFilter lineFilter;
+
+    for (uint32_t i = 0; i < NUM_VALIDATION_FRAMES; ++i) {
+        lineFilter.update({ { millimeter_t(0), 1.0f } }, FRAME_DISTANCE);
+    }
+
+    for (uint32_t i = 0; i < NUM_REMOVAL_FRAMES - 1; ++i) {
+        lineFilter.update(LinePositions(), FRAME_DISTANCE);
+    }
+
+    // the new line is outside the gate of the coasting line, and gets the ID of the line lost in the same frame,
+    // it is reported as a new line after the loss of the old one
+    lineFilter.update({ { millimeter_t(200), 1.0f } }, FRAME_DISTANCE);
+
+    ASSERT_EQ(2, lineFilter.events().size());
+    EXPECT_EQ(lineTrackEvent_t::Lost, lineFilter.events()[0].type);
+    EXPECT_EQ(1, lineFilter.events()[0].track.id);
+    EXPECT_NEAR_UNIT(millimeter_t(0), lineFilter.events()[0].track.pos, millimeter_t(1));
+    EXPECT_EQ(lineTrackEvent_t::Born, lineFilter.events()[1].type);
+    EXPECT_EQ(1, lineFilter.events()[1].track.id);
+    EXPECT_NEAR_UNIT(millimeter_t(200), lineFilter.events()[1].track.pos, millimeter_t(1));
+    EXPECT_EQ(1, lineFilter.events()[1].track.age);
+}
+
+TEST(LineFilter, multi_hypothesis_track_events) {
+    LineFilter lineFilter;
+    lineFilter.setMultiHypothesisEnabled(true);
+
+    for (uint32_t i = 0; i < 4 * NUM_VALIDATION_FRAMES; ++i) {
+        lineFilter.update({ { millimeter_t(0), 1.0f } }, FRAME_DISTANCE);
+    }
+
+    // the jump of the line is more likely than a new line, but the alternative of a new line is kept
+    lineFilter.update({ { millimeter_t(18), 1.0f } }, FRAME_DISTANCE);
+    ASSERT_EQ(1, lineFilter.tracks().size());
+    EXPECT_EQ(1, lineFilter.tracks()[0].id);
+    EXPECT_NEAR_UNIT(millimeter_t(18), lineFilter.tracks()[0].pos, millimeter_t(3));
+    EXPECT_EQ(0, lineFilter.events().size());
+
+    // the line is detected at its old position again, so the new line hypothesis becomes the most likely one,
+    // the line born in it in the previous frame is reported now, and the old line continues
+    lineFilter.update({ { millimeter_t(0), 1.0f }, { millimeter_t(18), 1.0f } }, FRAME_DISTANCE);
+    ASSERT_EQ(2, lineFilter.tracks().size());
+    EXPECT_EQ(1, lineFilter.tracks()[0].id);
+    EXPECT_NEAR_UNIT(millimeter_t(0), lineFilter.tracks()[0].pos, millimeter_t(1));
+    EXPECT_EQ(2, lineFilter.tracks()[1].id);
+
+    ASSERT_EQ(1, lineFilter.events().size());
+    EXPECT_EQ(lineTrackEvent_t::Born, lineFilter.events()[0].type);
+    EXPECT_EQ(2, lineFilter.events()[0].track.id);
+    EXPECT_EQ(2, lineFilter.events()[0].track.age);
+    EXPECT_NEAR_UNIT(millimeter_t(18), lineFilter.events()[0].track.pos, millimeter_t(1));
+}
+
+TEST(LineFilter, multi_hypothesis_merge) {
+    LineFilter lineFilter;
+    lineFilter.setMultiHypothesisEnabled(true);
+
+    for (uint32_t i = 0; i < 4 * NUM_VALIDATION_FRAMES; ++i) {
+        lineFilter.update({ { millimeter_t(0), 1.0f } }, FRAME_DISTANCE);
+    }
+    const uint8_t numSteadyHypotheses = lineFilter.numHypotheses();
+    EXPECT_LT(numSteadyHypotheses, cfg::LINE_FILTER_MAX_HYPOTHESES);
+
+    // a weak false detection is either a new line or the jump of the line, the alternatives are kept
+    for (uint32_t i = 0; i < 2; ++i) {
+        lineFilter.update({ { millimeter_t(0), 1.0f }, { millimeter_t(40), 0.6f } }, FRAME_DISTANCE);
+    }
+    EXPECT_GT(lineFilter.numHypotheses(), numSteadyHypotheses);
+
+    // once the false line is lost, the hypotheses that only differed in it are merged, and they do not fill the slots of the alternatives
+    for (uint32_t i = 0; i < 4 * NUM_VALIDATION_FRAMES; ++i) {
+        lineFilter.update({ { millimeter_t(0), 1.0f } }, FRAME_DISTANCE);
+    }
+    ASSERT_EQ(1, lineFilter.tracks().size());
+    EXPECT_EQ(numSteadyHypotheses, lineFilter.numHypotheses());
+}
+
+TEST(LineFilter, multi_hypothesis_crossing_lines) {
+    for (const float slope : { 0.2f, 0.3f, 0.5f }) {
+        LineFilter lineFilter;
+        lineFilter.setMultiHypothesisEnabled(true);
+        const std::vector<Lines> frames = replayCrossing(lineFilter, slope);
+
+        for (uint32_t i = NUM_VALIDATION_FRAMES - 1; i < frames.size(); ++i) {
+            // the merged image of the lines is shared by both of them, no line is dropped
+            ASSERT_EQ(2, frames[i].size()) << "slope: " << slope << ", frame: " << i;
+
+            // the line that started on the left is on the right after crossing the other one
+            const millimeter_t pos = millimeter_t(slope * (static_cast<float>((i + 1) * FRAME_DISTANCE.get()) - CROSSING_LENGTH / 2));
+            if (abs(2 * pos) >= 2 * cfg::MIN_LINE_DIST) {
+                const Lines::const_iterator line1 = std::find_if(frames[i].begin(), frames[i].end(), [] (const Line& l) { return 1 == l.id; });
+                const Lines::const_iterator line2 = std::find_if(frames[i].begin(), frames[i].end(), [] (const Line& l) { return 2 == l.id; });
+                ASSERT_NE(frames[i].end(), line1);
+                ASSERT_NE(frames[i].end(), line2);
+                EXPECT_NEAR_UNIT(pos, line1->pos, millimeter_t(5)) << "slope: " << slope << ", frame: " << i;
+                EXPECT_NEAR_UNIT(-pos, line2->pos, millimeter_t(5)) << "slope: " << slope << ", frame: " << i;
+            }
+        }
+    }
+}
+
+TEST(LineFilter, multi_hypothesis_frame_time) {
+
+    // the work of an update is bounded by the number of hypotheses and the number of search steps per hypothesis,
+    // the time is only measured for information, the host timing says nothing about the target
+    static constexpr uint32_t NUM_FRAMES = 2000;
+    static constexpr uint32_t NUM_REPEATS = 5;
+
+    // the worst case: the maximum number of detections, close to each other, so that all of them are within the gates of many lines
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> posDist(-20.0f, 20.0f), probabilityDist(cfg::MIN_LINE_PROBABILITY, 1.0f), distanceDist(0.0f, 12.0f);
+
+    LineFilter singleHypothesisFilter, multiHypothesisFilter;
+    multiHypothesisFilter.setMultiHypothesisEnabled(true);
+    std::chrono::nanoseconds singleHypothesisTime(0), multiHypothesisTime(0);
+    uint16_t maxSearchSteps = 0;
+
+    // returns the time of the update, the minimum of the repeats from the same state leaves out the interruptions of the host
+    const auto measureUpdate = [] (LineFilter& lineFilter, const LinePositions& linePositions, const millimeter_t distance) {
+        const LineFilter initial = lineFilter;
+        std::chrono::nanoseconds minTime = std::chrono::nanoseconds::max();
+        for (uint32_t i = 0; i < NUM_REPEATS; ++i) {
+            lineFilter = initial;
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            lineFilter.update(linePositions, distance);
+            minTime = std::min<std::chrono::nanoseconds>(minTime, std::chrono::steady_clock::now() - start);
+        }
+        return minTime;
+    };
+
+    for (uint32_t i = 0; i < NUM_FRAMES; ++i) {
+        LinePositions linePositions;
+        for (uint32_t j = 0; j < Line::MAX_NUM_LINES; ++j) {
+            linePositions.push_back({ millimeter_t(posDist(random)), probabilityDist(random) });
+        }
+        const millimeter_t distance = millimeter_t(distanceDist(random));
+
+        singleHypothesisTime = std::max(singleHypothesisTime, measureUpdate(singleHypothesisFilter, linePositions, distance));
+        multiHypothesisTime  = std::max(multiHypothesisTime, measureUpdate(multiHypothesisFilter, linePositions, distance));
+
+        ASSERT_LE(multiHypothesisFilter.numHypotheses(), cfg::LINE_FILTER_MAX_HYPOTHESES) << "frame: " << i;
+        ASSERT_LE(multiHypothesisFilter.maxSearchSteps(), cfg::LINE_HYPOTHESIS_MAX_SEARCH_STEPS) << "frame: " << i;
+        maxSearchSteps = std::max(maxSearchSteps, multiHypothesisFilter.maxSearchSteps());
+    }
+
+    // the detections are close enough to make the search reach its step limit
+    EXPECT_EQ(cfg::LINE_HYPOTHESIS_MAX_SEARCH_STEPS, maxSearchSteps);
+
+#if PRINT_MEAS
+    std::cout << "line filter worst case - single hypothesis: " << singleHypothesisTime.count() << " ns/frame, "
+              << static_cast<uint32_t>(cfg::LINE_FILTER_MAX_HYPOTHESES) << " hypotheses: " << multiHypothesisTime.count() << " ns/frame" << std::endl;
+#endif // PRINT_MEAS
+}
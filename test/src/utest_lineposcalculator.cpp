@@ -1,9 +1,13 @@
 #include <micro/math/numeric.hpp>
 #include <micro/test/utils.hpp>
 #include <LinePosCalculator.hpp>
+#include <SensorHandler.hpp>
+#include <SimdKernels.hpp>
 
+#include <chrono>
 #define PRINT_MEAS false
 #include <cmath>
+#include <cstring>
 
 #if PRINT_MEAS
 #include <iomanip>
@@ -94,4 +98,601 @@ TEST(LinePosCalculator, two_lines_close_right) {
 
 TEST(LinePosCalculator, two_lines_far) {
     test({ millimeter_t(-80), millimeter_t(70) });
-}
\ No newline at end of file
+}
+
+TEST(LinePosCalculator, three_lines) {
+    test({ millimeter_t(-90), millimeter_t(0), millimeter_t(90) });
+}
+
+TEST(LinePosCalculator, ambient_light) {
+    LinePosCalculator offsetFilterCalculator(false);
+    LinePosCalculator differentialCalculator(false);
+    differentialCalculator.setOffsetFilterEnabled(false);
+
+    const vec<millimeter_t, Line::MAX_NUM_LINES> lines = { millimeter_t(-30) };
+
+    // a sunlit patch with a sharp shadow edge on the right side of the panel
+    Measurements ambientLight;
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        ambientLight[i] = i < 30 ? 10 : 70;
+    }
+
+    Measurements measurements, raw;
+    millimeter_t offsetFilterMaxError, differentialMaxError;
+    uint32_t numOffsetFilterMisses = 0;
+    std::chrono::nanoseconds offsetFilterTime(0), differentialTime(0);
+
+    for (uint32_t i = 0; i < NUM_TESTS_PER_SCENARIO; ++i) {
+        createMeasurements(lines, measurements);
+
+        // the sensor reads the reflected LED light and the ambient light together
+        for (uint8_t s = 0; s < cfg::NUM_SENSORS; ++s) {
+            raw[s] = min<uint32_t>(measurements[s] + ambientLight[s], 255);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const LinePositions offsetFilterPositions = offsetFilterCalculator.calculate(raw);
+        offsetFilterTime += std::chrono::steady_clock::now() - start;
+
+        // the dark frame gives the ambient light directly, it is removed during the acquisition
+        Measurements differential = raw;
+        SensorHandler::removeAmbientLight(differential, ambientLight);
+
+        start = std::chrono::steady_clock::now();
+        const LinePositions differentialPositions = differentialCalculator.calculate(differential);
+        differentialTime += std::chrono::steady_clock::now() - start;
+
+        ASSERT_EQ(1, differentialPositions.size());
+        EXPECT_NEAR_UNIT(lines[0], differentialPositions[0].pos, millimeter_t(4));
+        differentialMaxError = max(differentialMaxError, abs(lines[0] - differentialPositions[0].pos));
+
+        if (1 == offsetFilterPositions.size()) {
+            offsetFilterMaxError = max(offsetFilterMaxError, abs(lines[0] - offsetFilterPositions[0].pos));
+        } else {
+            ++numOffsetFilterMisses;
+        }
+    }
+
+#if PRINT_MEAS
+    std::cout << "offset filter: max error " << offsetFilterMaxError.get() << " mm, missed/ghost frames: " << numOffsetFilterMisses
+              << ", time: " << offsetFilterTime.count() / NUM_TESTS_PER_SCENARIO << " ns/frame" << std::endl;
+    std::cout << "differential:  max error " << differentialMaxError.get() << " mm, time: "
+              << differentialTime.count() / NUM_TESTS_PER_SCENARIO << " ns/frame" << std::endl;
+#endif // PRINT_MEAS
+}
+
+namespace {
+
+// The original sort-based offset filter, kept as the reference of the selection kernel.
+void referenceFilterOffset(const float * const scaled, float * const OUT result) {
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        const uint8_t startIdx = max<uint8_t>(i, cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS) - cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS;
+        const uint8_t endIdx = min<uint8_t>(i + cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS + 1, cfg::NUM_SENSORS);
+
+        std::array<float, 2 * cfg::LINE_POS_CALC_OFFSET_FILTER_RADIUS + 1> group;
+        std::copy(&scaled[startIdx], &scaled[endIdx], group.begin());
+        std::sort(group.begin(), std::next(group.begin(), endIdx - startIdx));
+
+        result[i] = map(scaled[i], group[group.size() / 3], 1.0f, 0.0f, 1.0f);
+    }
+}
+
+} // namespace
+
+TEST(LinePosCalculator, offset_filter) {
+    static constexpr uint32_t NUM_FRAMES = 20000;
+
+    float scaled[cfg::NUM_SENSORS];
+    float expected[cfg::NUM_SENSORS];
+    float result[cfg::NUM_SENSORS];
+    std::chrono::nanoseconds referenceTime(0), kernelTime(0);
+
+    for (uint32_t i = 0; i < NUM_FRAMES; ++i) {
+        // few distinct values, so that the windows often contain equal values
+        for (uint8_t s = 0; s < cfg::NUM_SENSORS; ++s) {
+            scaled[s] = i % 2 ? (rand() % 8) / 7.0f : map<uint32_t, float>(rand() % 10000, 0, 10000, -0.2f, 1.0f);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        referenceFilterOffset(scaled, expected);
+        referenceTime += std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        LinePosCalculator::filterOffset(scaled, result);
+        kernelTime += std::chrono::steady_clock::now() - start;
+
+        // the output must be bit-identical to the sort-based filter
+        ASSERT_EQ(0, std::memcmp(expected, result, sizeof(result)));
+    }
+
+#if PRINT_MEAS
+    std::cout << "offset filter - sort: " << referenceTime.count() / NUM_FRAMES << " ns/frame, selection kernel: "
+              << kernelTime.count() / NUM_FRAMES << " ns/frame" << std::endl;
+#endif // PRINT_MEAS
+}
+
+TEST(LinePosCalculator, normalization) {
+    static constexpr float TOLERANCE = 1.0f / (1 << 23);
+
+    float maxError = 0.0f;
+
+    // all possible measurement and white level combinations
+    for (uint32_t whiteLevel = 0; whiteLevel <= 255; ++whiteLevel) {
+        const float scale = LinePosCalculator::whiteLevelScale(whiteLevel);
+
+        for (uint32_t value = 0; value <= 255; ++value) {
+            const uint8_t measurement = value, offset = whiteLevel;
+            const float expected = map<uint8_t>(value, whiteLevel, 255, 0.0f, 1.0f);
+            float result;
+            simd::scalar::normalize(&measurement, &offset, &scale, &result, 1);
+
+            EXPECT_NEAR(expected, result, TOLERANCE);
+            maxError = std::max(maxError, std::abs(expected - result));
+        }
+    }
+
+    Measurements measurements, whiteLevels;
+    std::array<float, cfg::NUM_SENSORS> scales;
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        whiteLevels[i] = 20 + i;
+        scales[i] = LinePosCalculator::whiteLevelScale(whiteLevels[i]);
+    }
+
+    static constexpr uint32_t NUM_FRAMES = 20000;
+    std::chrono::nanoseconds mapTime(0), scaleTime(0);
+    float mapSum = 0.0f, scaleSum = 0.0f; // keeps the loops from being optimized away
+    float normalized[cfg::NUM_SENSORS];
+
+    for (uint32_t f = 0; f < NUM_FRAMES; ++f) {
+        for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+            measurements[i] = rand() % 256;
+        }
+
+        // the frames are summed the same way, so that only the normalization differs
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        float frameSum = 0.0f;
+        for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+            frameSum += map<uint8_t>(measurements[i], whiteLevels[i], 255, 0.0f, 1.0f);
+        }
+        mapSum += frameSum;
+        mapTime += std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        simd::normalize(measurements.data(), whiteLevels.data(), scales.data(), normalized, cfg::NUM_SENSORS);
+        scaleSum += simd::scalar::sum(normalized, cfg::NUM_SENSORS);
+        scaleTime += std::chrono::steady_clock::now() - start;
+    }
+
+    EXPECT_NEAR(mapSum, scaleSum, NUM_FRAMES * cfg::NUM_SENSORS * TOLERANCE);
+
+#if PRINT_MEAS
+    std::cout << "normalization - max error: " << maxError << ", map: " << mapTime.count() / NUM_FRAMES
+              << " ns/frame, scale: " << scaleTime.count() / NUM_FRAMES << " ns/frame" << std::endl;
+#endif // PRINT_MEAS
+}
+
+TEST(LinePosCalculator, white_level_calibration) {
+    LinePosCalculator linePosCalculator(true);
+    std::array<float, cfg::NUM_SENSORS> sums = {};
+
+    // white surface with sensor-specific offsets and noise, no lines
+    for (uint32_t f = 0; f < cfg::WHITE_LEVEL_CALIBRATION_FRAMES; ++f) {
+        EXPECT_FALSE(linePosCalculator.isCalibrated());
+
+        Measurements measurements;
+        for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+            measurements[i] = 40 + i % 8 + rand() % 9 - 4;
+            sums[i] += measurements[i];
+        }
+
+        EXPECT_TRUE(linePosCalculator.calculate(measurements).empty());
+    }
+
+    ASSERT_TRUE(linePosCalculator.isCalibrated());
+
+    // same result as averaging the stored frames
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_EQ(static_cast<uint8_t>(micro::round(sums[i] / cfg::WHITE_LEVEL_CALIBRATION_FRAMES)), linePosCalculator.whiteLevels()[i]);
+    }
+}
+
+namespace {
+
+// white surface with sensor-specific offsets and noise, the lines are added on top of it
+void createMeasurements(const vec<millimeter_t, Line::MAX_NUM_LINES>& lines, const uint8_t whiteLevel, Measurements& meas) {
+    createMeasurements(lines, meas);
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        meas[i] = clamp<int32_t>(meas[i] + whiteLevel + i % 8 + rand() % 5 - 2, 0, 255);
+    }
+}
+
+} // namespace
+
+TEST(LinePosCalculator, white_level_adaptation_startup) {
+    const vec<millimeter_t, Line::MAX_NUM_LINES> lines = { millimeter_t(-30), millimeter_t(60) };
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        LinePosCalculator linePosCalculator(true);
+        linePosCalculator.setWhiteLevelAdaptationEnabled(true);
+
+        Measurements measurements;
+        createMeasurements(lines, 40, measurements);
+
+        // lines are detected in the very first frame
+        const LinePositions linePositions = linePosCalculator.calculate(measurements);
+        EXPECT_TRUE(linePosCalculator.isCalibrated());
+        ASSERT_EQ(lines.size(), linePositions.size());
+        for (uint8_t l = 0; l < linePositions.size(); ++l) {
+            EXPECT_NEAR_UNIT(lines[l], linePositions[l].pos, millimeter_t(4));
+        }
+    }
+}
+
+TEST(LinePosCalculator, white_level_adaptation_unscanned_frame) {
+    const vec<millimeter_t, Line::MAX_NUM_LINES> lines = { millimeter_t(-30), millimeter_t(60) };
+
+    LinePosCalculator linePosCalculator(true);
+    linePosCalculator.setWhiteLevelAdaptationEnabled(true);
+
+    // the first frame is not scanned, it does not initialize the white levels
+    Measurements measurements;
+    measurements.fill(0);
+    EXPECT_TRUE(linePosCalculator.calculate(measurements, SensorMask()).empty());
+    EXPECT_FALSE(linePosCalculator.isCalibrated());
+
+    // lines are detected in the first scanned frame
+    createMeasurements(lines, 40, measurements);
+    const LinePositions linePositions = linePosCalculator.calculate(measurements);
+    EXPECT_TRUE(linePosCalculator.isCalibrated());
+    ASSERT_EQ(lines.size(), linePositions.size());
+    for (uint8_t l = 0; l < linePositions.size(); ++l) {
+        EXPECT_NEAR_UNIT(lines[l], linePositions[l].pos, millimeter_t(4));
+    }
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_LE(36, linePosCalculator.whiteLevels()[i]);
+    }
+}
+
+TEST(LinePosCalculator, white_level_adaptation_lighting) {
+    static constexpr uint8_t INITIAL_WHITE_LEVEL = 40;
+    static constexpr uint8_t CHANGED_WHITE_LEVEL = 70;
+
+    const vec<millimeter_t, Line::MAX_NUM_LINES> lines = { millimeter_t(-30) };
+    const uint8_t lineIdx = micro::round(LinePosCalculator::linePosToOptoPos(lines[0]));
+
+    LinePosCalculator linePosCalculator(true);
+    linePosCalculator.setWhiteLevelAdaptationEnabled(true);
+    linePosCalculator.setOffsetFilterEnabled(false);
+
+    Measurements measurements;
+    createMeasurements(lines, INITIAL_WHITE_LEVEL, measurements);
+    linePosCalculator.calculate(measurements);
+    const Measurements initialWhiteLevels = linePosCalculator.whiteLevels();
+
+    // the lighting changes, the sensors that are not covered by the line follow it
+    for (uint32_t i = 0; i < 1000; ++i) {
+        createMeasurements(lines, CHANGED_WHITE_LEVEL, measurements);
+        const LinePositions linePositions = linePosCalculator.calculate(measurements);
+        ASSERT_EQ(lines.size(), linePositions.size());
+        EXPECT_NEAR_UNIT(lines[0], linePositions[0].pos, millimeter_t(4));
+    }
+
+    // the sensors at the edge of the line group are not checked, they are covered by the line in some of the frames only
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        if (abs(i - lineIdx) < cfg::WHITE_LEVEL_LINE_GROUP_RADIUS) {
+            EXPECT_EQ(initialWhiteLevels[i], linePosCalculator.whiteLevels()[i]);
+        } else if (abs(i - lineIdx) > cfg::WHITE_LEVEL_LINE_GROUP_RADIUS + 1) {
+            EXPECT_NEAR(CHANGED_WHITE_LEVEL + i % 8, linePosCalculator.whiteLevels()[i], 1);
+        }
+    }
+}
+
+TEST(LinePosCalculator, saved_white_levels) {
+    const vec<millimeter_t, Line::MAX_NUM_LINES> lines = { millimeter_t(-30) };
+
+    LinePosCalculator calibratedCalculator(true);
+    Measurements measurements;
+    for (uint32_t i = 0; i < cfg::WHITE_LEVEL_CALIBRATION_FRAMES; ++i) {
+        createMeasurements({}, 40, measurements);
+        calibratedCalculator.calculate(measurements);
+    }
+    ASSERT_TRUE(calibratedCalculator.hasUnsavedWhiteLevels());
+
+    // the saved white levels are used right away
+    LinePosCalculator linePosCalculator(true);
+    linePosCalculator.setWhiteLevels(calibratedCalculator.whiteLevels());
+    EXPECT_TRUE(linePosCalculator.isCalibrated());
+    EXPECT_FALSE(linePosCalculator.hasUnsavedWhiteLevels());
+
+    for (uint32_t i = 0; i < cfg::WHITE_LEVEL_CHECK_FRAMES; ++i) {
+        EXPECT_TRUE(linePosCalculator.isCheckingWhiteLevels());
+        createMeasurements(lines, 40, measurements);
+        const LinePositions linePositions = linePosCalculator.calculate(measurements);
+        ASSERT_EQ(lines.size(), linePositions.size());
+        EXPECT_NEAR_UNIT(lines[0], linePositions[0].pos, millimeter_t(4));
+    }
+
+    EXPECT_FALSE(linePosCalculator.isCheckingWhiteLevels());
+    EXPECT_TRUE(linePosCalculator.isCalibrated());
+    EXPECT_EQ(calibratedCalculator.whiteLevels(), linePosCalculator.whiteLevels());
+}
+
+TEST(LinePosCalculator, saved_white_levels_partial_frames) {
+    SensorMask activeSensors;
+    for (uint8_t i = 10; i < 21; ++i) {
+        activeSensors.set(i);
+    }
+
+    Measurements savedWhiteLevels;
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        savedWhiteLevels[i] = 40 + i % 8;
+    }
+
+    LinePosCalculator linePosCalculator(true);
+    linePosCalculator.setWhiteLevels(savedWhiteLevels);
+
+    // the unscanned sensors of the partial frames are not mismatches
+    Measurements measurements;
+    for (uint32_t i = 0; i < cfg::WHITE_LEVEL_CHECK_FRAMES; ++i) {
+        createMeasurements({}, 40, measurements);
+        for (uint8_t s = 0; s < cfg::NUM_SENSORS; ++s) {
+            if (!activeSensors.test(s)) {
+                measurements[s] = 0;
+            }
+        }
+        linePosCalculator.calculate(measurements, activeSensors);
+    }
+
+    EXPECT_FALSE(linePosCalculator.isCheckingWhiteLevels());
+    EXPECT_TRUE(linePosCalculator.isCalibrated());
+    EXPECT_EQ(savedWhiteLevels, linePosCalculator.whiteLevels());
+}
+
+TEST(LinePosCalculator, saved_white_levels_mismatch) {
+    Measurements savedWhiteLevels;
+    savedWhiteLevels.fill(40);
+
+    LinePosCalculator linePosCalculator(true);
+    linePosCalculator.setWhiteLevels(savedWhiteLevels);
+
+    // the surface is much brighter than the saved white levels, the calibration is restarted
+    Measurements measurements;
+    for (uint32_t i = 0; i < cfg::WHITE_LEVEL_CHECK_FRAMES; ++i) {
+        createMeasurements({}, 120, measurements);
+        linePosCalculator.calculate(measurements);
+    }
+
+    EXPECT_FALSE(linePosCalculator.isCheckingWhiteLevels());
+    EXPECT_FALSE(linePosCalculator.isCalibrated());
+
+    for (uint32_t i = 0; i < cfg::WHITE_LEVEL_CALIBRATION_FRAMES; ++i) {
+        createMeasurements({}, 120, measurements);
+        linePosCalculator.calculate(measurements);
+    }
+
+    EXPECT_TRUE(linePosCalculator.isCalibrated());
+    EXPECT_TRUE(linePosCalculator.hasUnsavedWhiteLevels());
+    EXPECT_NEAR(120, linePosCalculator.whiteLevels()[0], 2);
+}
+
+TEST(LinePosCalculator, active_sensors) {
+    const vec<millimeter_t, Line::MAX_NUM_LINES> lines = { millimeter_t(-30), millimeter_t(60) };
+    static constexpr uint8_t RADIUS = 5;
+
+    // one scan range around each line, the other sensors are not scanned
+    SensorMask activeSensors;
+    for (const millimeter_t line : lines) {
+        const uint8_t center = micro::round(LinePosCalculator::linePosToOptoPos(line));
+        for (uint8_t i = center - RADIUS; i <= center + RADIUS; ++i) {
+            activeSensors.set(i);
+        }
+    }
+
+    LinePosCalculator linePosCalculator(false);
+    Measurements measurements;
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        createMeasurements(lines, measurements);
+        for (uint8_t s = 0; s < cfg::NUM_SENSORS; ++s) {
+            if (!activeSensors.test(s)) {
+                measurements[s] = 0;
+            }
+        }
+
+        const LinePositions linePositions = linePosCalculator.calculate(measurements, activeSensors);
+        ASSERT_EQ(lines.size(), linePositions.size());
+        for (uint8_t l = 0; l < linePositions.size(); ++l) {
+            EXPECT_NEAR_UNIT(lines[l], linePositions[l].pos, millimeter_t(4));
+        }
+    }
+
+    // only the scan range of the first line is active, the measurements of the second line are ignored
+    SensorMask firstRange;
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS / 2; ++i) {
+        firstRange.set(i, activeSensors.test(i));
+    }
+
+    createMeasurements(lines, measurements);
+    const LinePositions linePositions = linePosCalculator.calculate(measurements, firstRange);
+    ASSERT_EQ(1, linePositions.size());
+    EXPECT_NEAR_UNIT(lines[0], linePositions[0].pos, millimeter_t(4));
+
+    // the scanned sensors are mostly dark, the sensors that have not been scanned must not make the frame look white
+    LinePosCalculator darkCalculator(false);
+    darkCalculator.setOffsetFilterEnabled(false);
+    const uint8_t center = micro::round(LinePosCalculator::linePosToOptoPos(lines[0]));
+    measurements.fill(255);
+    measurements[center - 1] = measurements[center] = measurements[center + 1] = 0;
+    EXPECT_TRUE(darkCalculator.calculate(measurements, firstRange).empty());
+
+    EXPECT_TRUE(linePosCalculator.calculate(measurements, SensorMask()).empty());
+}
+
+TEST(LinePosCalculator, active_sensors_narrow_ranges) {
+    const millimeter_t line(-30);
+    static constexpr uint8_t RADIUS = 5;
+    const uint8_t center = micro::round(LinePosCalculator::linePosToOptoPos(line));
+
+    // the narrow ranges are smaller than the offset filter window, they must not spoil the line in the wide range
+    LinePosCalculator linePosCalculator(false);
+    Measurements measurements;
+
+    for (uint8_t size = 1; size <= 2; ++size) {
+        SensorMask activeSensors;
+        for (uint8_t i = center - RADIUS; i <= center + RADIUS; ++i) {
+            activeSensors.set(i);
+        }
+        for (uint8_t i = center + 3 * RADIUS; i < center + 3 * RADIUS + size; ++i) {
+            activeSensors.set(i);
+        }
+
+        for (uint32_t i = 0; i < 100; ++i) {
+            createMeasurements({ line }, measurements);
+            for (uint8_t s = 0; s < cfg::NUM_SENSORS; ++s) {
+                if (!activeSensors.test(s)) {
+                    measurements[s] = 0;
+                }
+            }
+
+            const LinePositions linePositions = linePosCalculator.calculate(measurements, activeSensors);
+            ASSERT_EQ(1, linePositions.size()) << "size: " << static_cast<uint32_t>(size);
+            EXPECT_NEAR_UNIT(line, linePositions[0].pos, millimeter_t(4));
+        }
+    }
+}
+
+TEST(LinePosCalculator, active_sensors_calibration) {
+    SensorMask activeSensors;
+    for (uint8_t i = 10; i < 20; ++i) {
+        activeSensors.set(i);
+    }
+
+    // the white levels of all sensors are needed, so partial frames are not used for the calibration
+    LinePosCalculator linePosCalculator(true);
+    Measurements measurements;
+    for (uint32_t i = 0; i < cfg::WHITE_LEVEL_CALIBRATION_FRAMES; ++i) {
+        createMeasurements({}, 40, measurements);
+        linePosCalculator.calculate(measurements, activeSensors);
+    }
+    EXPECT_FALSE(linePosCalculator.isCalibrated());
+
+    LinePosCalculator adaptiveCalculator(true);
+    adaptiveCalculator.setWhiteLevelAdaptationEnabled(true);
+    createMeasurements({}, 40, measurements);
+    adaptiveCalculator.calculate(measurements, activeSensors);
+    EXPECT_FALSE(adaptiveCalculator.isCalibrated());
+
+    adaptiveCalculator.calculate(measurements);
+    EXPECT_TRUE(adaptiveCalculator.isCalibrated());
+}
+
+namespace {
+
+// Detects lines on a panel of the given geometry, and measures the calculation time per frame.
+template <typename Geometry>
+void testGeometry() {
+    typedef BasicLinePosCalculator<Geometry> calculator_t;
+
+    static constexpr uint32_t NUM_FRAMES = 2000;
+    static constexpr double SIGMA = 1.0;
+
+    const vec<millimeter_t, Line::MAX_NUM_LINES> lines = { -Geometry::ARRAY_LENGTH / 4, Geometry::ARRAY_LENGTH / 4 };
+
+    calculator_t linePosCalculator(false);
+    typename calculator_t::measurements_t measurements;
+    std::chrono::nanoseconds calcTime(0);
+
+    for (uint32_t f = 0; f < NUM_FRAMES; ++f) {
+        measurements.fill(0);
+        for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+            for (const millimeter_t linePos : lines) {
+                const double z_score = (i - calculator_t::linePosToOptoPos(linePos)) / SIGMA;
+                measurements[i] = clamp<int32_t>(measurements[i] + 255 * exp(-0.5 * z_score * z_score) + rand() % 9 - 4, 0, 255);
+            }
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const LinePositions linePositions = linePosCalculator.calculate(measurements);
+        calcTime += std::chrono::steady_clock::now() - start;
+
+        ASSERT_EQ(lines.size(), linePositions.size());
+        for (uint8_t l = 0; l < lines.size(); ++l) {
+            EXPECT_NEAR_UNIT(lines[l], linePositions[l].pos, millimeter_t(4));
+        }
+    }
+
+#if PRINT_MEAS
+    std::cout << static_cast<uint32_t>(Geometry::NUM_SENSORS) << " sensors: " << calcTime.count() / NUM_FRAMES << " ns/frame" << std::endl;
+#endif // PRINT_MEAS
+}
+
+} // namespace
+
+TEST(LinePosCalculator, geometries) {
+    testGeometry<PanelGeometry<32>>();
+    testGeometry<PanelGeometry<48>>();
+    testGeometry<PanelGeometry<64>>();
+}
+
+namespace {
+
+struct estimatorResult_t {
+    millimeter_t sumError;
+    millimeter_t maxError;
+    std::chrono::nanoseconds calcTime;
+    uint32_t numLines = 0;
+};
+
+// Measures the accuracy and the calculation time of an estimator on the synthetic lines, at random sub-sensor positions.
+estimatorResult_t testEstimator(const linePosEstimator_t estimator) {
+    static constexpr uint32_t NUM_FRAMES = 10000;
+
+    LinePosCalculator linePosCalculator(false);
+    linePosCalculator.setEstimator(estimator);
+    estimatorResult_t result;
+    result.calcTime = std::chrono::nanoseconds(0);
+    Measurements measurements;
+
+    srand(0);
+    for (uint32_t f = 0; f < NUM_FRAMES; ++f) {
+        const millimeter_t pos = millimeter_t(static_cast<float>(rand() % 2000 - 1000) / 10);
+        const vec<millimeter_t, Line::MAX_NUM_LINES> lines = f % 2 ? vec<millimeter_t, Line::MAX_NUM_LINES>{ pos } : vec<millimeter_t, Line::MAX_NUM_LINES>{ pos - millimeter_t(25), pos + millimeter_t(25) };
+        createMeasurements(lines, measurements);
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const LinePositions linePositions = linePosCalculator.calculate(measurements);
+        result.calcTime += std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(lines.size(), linePositions.size());
+        for (uint8_t i = 0; i < std::min(lines.size(), linePositions.size()); ++i) {
+            const millimeter_t error = abs(lines[i] - linePositions[i].pos);
+            result.sumError += error;
+            result.maxError = max(result.maxError, error);
+            ++result.numLines;
+        }
+    }
+
+#if PRINT_MEAS
+    std::cout << "estimator " << static_cast<uint32_t>(estimator) << " - error: " << (result.sumError / result.numLines).get()
+              << " mm on average, " << result.maxError.get() << " mm max, time: " << result.calcTime.count() / NUM_FRAMES << " ns/frame" << std::endl;
+#endif // PRINT_MEAS
+
+    return result;
+}
+
+} // namespace
+
+TEST(LinePosCalculator, estimators) {
+    const estimatorResult_t centroid      = testEstimator(linePosEstimator_t::Centroid);
+    const estimatorResult_t matchedFilter = testEstimator(linePosEstimator_t::MatchedFilter);
+    const estimatorResult_t peakFit       = testEstimator(linePosEstimator_t::PeakFit);
+
+    for (const estimatorResult_t& result : { centroid, matchedFilter, peakFit }) {
+        EXPECT_GT(result.numLines, 0);
+        EXPECT_GT(millimeter_t(4), result.maxError);
+    }
+
+    // the matched filter uses the whole line profile, so it is less sensitive to the noise of the single sensors
+    EXPECT_LT(matchedFilter.sumError / matchedFilter.numLines, centroid.sumError / centroid.numLines);
+}
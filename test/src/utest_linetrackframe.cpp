@@ -0,0 +1,46 @@
+#include <micro/test/utils.hpp>
+#include <LineTrackFrame.hpp>
+
+using namespace micro;
+
+TEST(LineTrackFrame, encode_decode) {
+    LineTrack track;
+    track.id              = 5;
+    track.pos             = millimeter_t(-43.27f);
+    track.slope           = 0.318f;
+    track.age             = 17;
+    track.numMissedFrames = 2;
+    track.confidence      = 0.6f;
+    track.isValidated     = true;
+
+    const can::FrontLineTrack frame(track, lineTrackEvent_t::Validated);
+
+    LineTrack result;
+    lineTrackEvent_t event;
+    frame.acquire(result, event);
+
+    EXPECT_EQ(lineTrackEvent_t::Validated, event);
+    EXPECT_EQ(track.id, result.id);
+    EXPECT_NEAR_UNIT(track.pos, result.pos, millimeter_t(0.05f));
+    EXPECT_NEAR(track.slope, result.slope, 0.0005f);
+    EXPECT_EQ(track.age, result.age);
+    EXPECT_EQ(track.numMissedFrames, result.numMissedFrames);
+    EXPECT_NEAR(track.confidence, result.confidence, 0.002f);
+    EXPECT_TRUE(result.isValidated);
+}
+
+TEST(LineTrackFrame, saturation) {
+    LineTrack track;
+    track.id    = 1;
+    track.slope = 100.0f;
+    track.age   = 1000;
+
+    LineTrack result;
+    lineTrackEvent_t event;
+    can::RearLineTrack(track, lineTrackEvent_t::Born).acquire(result, event);
+
+    EXPECT_EQ(lineTrackEvent_t::Born, event);
+    EXPECT_FALSE(result.isValidated);
+    EXPECT_NEAR(32.767f, result.slope, 0.0005f);
+    EXPECT_EQ(255, result.age);
+}
@@ -0,0 +1,382 @@
+#include <micro/math/numeric.hpp>
+#include <micro/test/utils.hpp>
+#include <MockSensorBus.hpp>
+#include <SensorHandler.hpp>
+
+#define PRINT_BENCHMARK false
+#include <cmath>
+
+#if PRINT_BENCHMARK
+#include <iostream>
+#endif // PRINT_BENCHMARK
+
+using namespace micro;
+
+namespace {
+
+void fillIntensities(Measurements& intensities) {
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        intensities[i] = 10 + 4 * i;
+    }
+}
+
+SensorMask rangeMask(const uint8_t first, const uint8_t last) {
+    SensorMask mask;
+    for (uint8_t i = first; i <= last; ++i) {
+        mask.set(i);
+    }
+    return mask;
+}
+
+} // namespace
+
+TEST(ScanSequencer, full_frame) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    fillIntensities(bus.intensities);
+    measurements.fill(0);
+    table.build(SensorMask().set(), 1);
+    bus.run(sequencer, table, measurements);
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_EQ(bus.intensities[i], measurements[i]);
+    }
+
+    EXPECT_EQ(0, bus.numUnlitReads);
+    EXPECT_EQ(0, bus.numUnsettledReads);
+    EXPECT_EQ(NUM_SCAN_GROUPS + cfg::NUM_SENSORS, bus.stats.transactions);
+    EXPECT_EQ(1, bus.stats.wakeups); // previously the task was woken up after each transaction
+    EXPECT_FALSE(sequencer.isBusy());
+}
+
+TEST(ScanSequencer, settle_time) {
+    static constexpr uint32_t SETTLE_TIME = static_cast<uint32_t>(cfg::OPTO_SETTLE_TIME.get());
+
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    fillIntensities(bus.intensities);
+    table.build(SensorMask().set(), 1);
+    bus.run(sequencer, table, measurements);
+
+    // the CPU is released for the whole settle period of each group instead of busy-waiting
+    EXPECT_EQ(NUM_SCAN_GROUPS * SETTLE_TIME, sequencer.stats().settleTime);
+    EXPECT_EQ(NUM_SCAN_GROUPS * SETTLE_TIME, bus.stats.idleTime);
+    EXPECT_EQ(bus.stats.busyTime + bus.stats.idleTime, bus.time);
+    EXPECT_EQ(0, bus.numUnsettledReads);
+
+    // groups without sensors in the scan range are skipped
+    table.build(rangeMask(0, 7), 1);
+    bus.run(sequencer, table, measurements);
+
+    EXPECT_EQ((NUM_SCAN_GROUPS + 8) * SETTLE_TIME, sequencer.stats().settleTime);
+    EXPECT_EQ(2, sequencer.stats().frames);
+}
+
+TEST(ScanSequencer, pipelined) {
+    MockSensorBus sequentialBus;
+    ScanSequencer<MockSensorBus> sequentialSequencer(sequentialBus);
+    MockSensorBus pipelinedBus;
+    ScanSequencer<MockSensorBus> pipelinedSequencer(pipelinedBus);
+    ScanTable table;
+    Measurements measurements;
+
+    pipelinedSequencer.setMode(scanMode_t::Pipelined);
+    fillIntensities(sequentialBus.intensities);
+    fillIntensities(pipelinedBus.intensities);
+    table.build(SensorMask().set(), 1);
+
+    sequentialBus.run(sequentialSequencer, table, measurements);
+
+    measurements.fill(0);
+    pipelinedBus.run(pipelinedSequencer, table, measurements);
+
+    EXPECT_EQ(pipelinedBus.intensities, measurements);
+    EXPECT_EQ(0, pipelinedBus.numUnlitReads);
+    EXPECT_EQ(0, pipelinedBus.numUnsettledReads);
+    EXPECT_EQ(0, pipelinedBus.numInvalidLatches);
+    EXPECT_EQ(0, sequentialBus.numInvalidLatches);
+
+    // the LEDs are only switched on once per frame, the groups are switched by the latch pulses
+    EXPECT_EQ(NUM_SCAN_GROUPS, sequentialBus.numOptoEnables);
+    EXPECT_EQ(1, pipelinedBus.numOptoEnables);
+    EXPECT_EQ(sequentialBus.stats.gpioWrites - 2 * (NUM_SCAN_GROUPS - 1), pipelinedBus.stats.gpioWrites);
+
+    // the settle periods and the transfers take the same time in both modes, the frame is shorter by the saved LED blanking
+    EXPECT_EQ(sequentialBus.stats.idleTime, pipelinedBus.stats.idleTime);
+    EXPECT_LT(pipelinedBus.time, sequentialBus.time);
+    EXPECT_EQ(sequentialBus.time - 2 * (NUM_SCAN_GROUPS - 1) * MockSensorBus::GPIO_WRITE_TIME, pipelinedBus.time);
+}
+
+TEST(ScanSequencer, pipelined_scan_range) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    sequencer.setMode(scanMode_t::Pipelined);
+    fillIntensities(bus.intensities);
+    measurements.fill(0);
+    table.build(rangeMask(5, 12), 1);
+    bus.run(sequencer, table, measurements);
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_EQ(isBtw<uint8_t>(i, 5, 12) ? bus.intensities[i] : 0, measurements[i]);
+    }
+
+    EXPECT_EQ(0, bus.numUnlitReads);
+    EXPECT_EQ(0, bus.numUnsettledReads);
+    EXPECT_EQ(0, bus.numInvalidLatches);
+}
+
+TEST(ScanSequencer, scan_range) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    fillIntensities(bus.intensities);
+    measurements.fill(0);
+    table.build(rangeMask(10, 20), 1);
+    bus.run(sequencer, table, measurements);
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_EQ(isBtw<uint8_t>(i, 10, 20) ? bus.intensities[i] : 0, measurements[i]);
+    }
+
+    EXPECT_EQ(0, bus.numUnlitReads);
+    EXPECT_EQ(0, bus.numUnsettledReads);
+    EXPECT_EQ(11 + 11, bus.stats.transactions); // sensors 10..20 are in 11 different groups
+    EXPECT_EQ(1, bus.stats.wakeups);
+}
+
+TEST(ScanSequencer, multiple_scan_ranges) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    // two separate lines, tracked with one narrow range each
+    const SensorMask mask = rangeMask(6, 9) | rangeMask(22, 25);
+
+    fillIntensities(bus.intensities);
+    measurements.fill(0);
+    table.build(mask, 1);
+    bus.run(sequencer, table, measurements);
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_EQ(mask.test(i) ? bus.intensities[i] : 0, measurements[i]);
+    }
+
+    // sensors 16 positions apart share their groups: (6,22) (7,23) (8,24) (9,25)
+    EXPECT_EQ(4 + 8, bus.stats.transactions);
+    EXPECT_EQ(4 * static_cast<uint32_t>(cfg::OPTO_SETTLE_TIME.get()), sequencer.stats().settleTime);
+    EXPECT_EQ(0, bus.numUnlitReads);
+    EXPECT_EQ(0, bus.numUnsettledReads);
+}
+
+TEST(ScanSequencer, empty_mask) {
+    ScanTable table;
+    table.build(SensorMask(), 1);
+    EXPECT_TRUE(table.transactions().empty());
+}
+
+TEST(ScanSequencer, consecutive_frames) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    fillIntensities(bus.intensities);
+    table.build(SensorMask().set(), 1);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        measurements.fill(0);
+        bus.run(sequencer, table, measurements);
+        EXPECT_EQ(bus.intensities, measurements);
+    }
+
+    EXPECT_EQ(10 * (NUM_SCAN_GROUPS + cfg::NUM_SENSORS), bus.stats.transactions);
+    EXPECT_EQ(10, bus.stats.wakeups);
+}
+
+TEST(ScanSequencer, dark_frame) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    fillIntensities(bus.intensities);
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        bus.ambientLight[i] = i;
+    }
+
+    measurements.fill(0);
+    table.buildDark(rangeMask(10, 20));
+    bus.run(sequencer, table, measurements);
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_EQ(isBtw<uint8_t>(i, 10, 20) ? bus.ambientLight[i] : 0, measurements[i]);
+    }
+
+    // no selectors are shifted and no settle time is needed, the sensors are read back-to-back
+    EXPECT_EQ(11, bus.stats.transactions);
+    EXPECT_EQ(0, bus.numOptoEnables);
+    EXPECT_EQ(0, sequencer.stats().settleTime);
+    EXPECT_EQ(1, bus.stats.wakeups);
+}
+
+TEST(ScanSequencer, ambient_light_cancellation) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable litTable, darkTable;
+    Measurements measurements, ambientLight;
+
+    // a sunlit patch on one side of the panel
+    fillIntensities(bus.intensities);
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        bus.ambientLight[i] = i < 20 ? 5 : 60;
+    }
+
+    sequencer.setMode(scanMode_t::Pipelined);
+    litTable.build(SensorMask().set(), 1);
+    darkTable.buildDark(SensorMask().set());
+
+    bus.run(sequencer, darkTable, ambientLight);
+    bus.run(sequencer, litTable, measurements);
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        EXPECT_EQ(micro::min<uint32_t>(bus.intensities[i] + bus.ambientLight[i], 255), measurements[i]);
+    }
+
+    SensorHandler::removeAmbientLight(measurements, ambientLight);
+
+    for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+        // the ADC saturates, so the differential value is only exact below the saturation limit
+        EXPECT_EQ(micro::min<uint32_t>(bus.intensities[i] + bus.ambientLight[i], 255) - bus.ambientLight[i], measurements[i]);
+    }
+}
+
+TEST(ScanSequencer, oversampling) {
+    MockSensorBus bus;
+    ScanSequencer<MockSensorBus> sequencer(bus);
+    ScanTable table;
+    Measurements measurements;
+
+    fillIntensities(bus.intensities);
+    sequencer.setMode(scanMode_t::Pipelined);
+
+    for (uint8_t numSamples = 1; numSamples <= MAX_ADC_SAMPLES; ++numSamples) {
+        measurements.fill(0);
+        table.build(SensorMask().set(), numSamples);
+        bus.run(sequencer, table, measurements);
+
+        EXPECT_EQ(bus.intensities, measurements);
+    }
+
+    // the samples of a sensor are converted in one burst, the number of transactions does not change
+    EXPECT_EQ(MAX_ADC_SAMPLES * (NUM_SCAN_GROUPS + cfg::NUM_SENSORS), bus.stats.transactions);
+    EXPECT_EQ(0, bus.numUnlitReads);
+    EXPECT_EQ(0, bus.numUnsettledReads);
+    EXPECT_EQ(0, bus.numInvalidLatches);
+}
+
+TEST(ScanSequencer, oversampling_noise) {
+    static constexpr uint32_t NUM_FRAMES = 200;
+
+    const sampleFilter_t filters[] = { sampleFilter_t::Mean, sampleFilter_t::Median };
+
+    for (const sampleFilter_t filter : filters) {
+        float singleSampleError = 0.0f;
+        float prevError = 1000.0f;
+        uint32_t prevFrameTime = 0;
+
+        for (uint8_t numSamples = 1; numSamples <= MAX_ADC_SAMPLES; ++numSamples) {
+            MockSensorBus bus;
+            ScanSequencer<MockSensorBus> sequencer(bus);
+            ScanTable table;
+            Measurements measurements;
+
+            srand(0);
+            fillIntensities(bus.intensities);
+            bus.noise = 12;
+            sequencer.setMode(scanMode_t::Pipelined);
+            sequencer.setSampleFilter(filter);
+            table.build(SensorMask().set(), numSamples);
+
+            float sumSquaredError = 0.0f;
+            for (uint32_t i = 0; i < NUM_FRAMES; ++i) {
+                bus.run(sequencer, table, measurements);
+                for (uint8_t s = 0; s < cfg::NUM_SENSORS; ++s) {
+                    const float error = static_cast<float>(measurements[s]) - bus.intensities[s];
+                    sumSquaredError += error * error;
+                }
+            }
+
+            const float error = std::sqrt(sumSquaredError / (NUM_FRAMES * cfg::NUM_SENSORS));
+            const uint32_t frameTime = bus.time / NUM_FRAMES;
+
+            // the median is less effective against uniform noise than the mean, it is only guaranteed to be better than no oversampling
+            if (1 == numSamples) {
+                singleSampleError = error;
+            } else if (sampleFilter_t::Mean == filter) {
+                EXPECT_LT(error, prevError);
+            } else {
+                EXPECT_LT(error, singleSampleError);
+            }
+            EXPECT_GT(frameTime, prevFrameTime);
+
+#if PRINT_BENCHMARK
+            std::cout << (sampleFilter_t::Mean == filter ? "mean  " : "median") << " x" << static_cast<uint32_t>(numSamples)
+                      << ": frame time " << frameTime << " us, rms error " << error << std::endl;
+#endif // PRINT_BENCHMARK
+
+            prevError = error;
+            prevFrameTime = frameTime;
+        }
+    }
+}
+
+namespace {
+
+// Checks that every sensor of the panel is read exactly once, and that it is lit by the selector of its group.
+template <typename Geometry>
+void testScanTableGeometry() {
+    typedef BasicScanTable<Geometry> table_t;
+
+    table_t table;
+    table.build(typename Geometry::sensorMask_t().set(), 1);
+
+    std::array<uint8_t, Geometry::NUM_SENSORS> numReads = {};
+    const uint8_t *selector = nullptr;
+
+    for (const typename table_t::transaction_t& t : table.transactions()) {
+        if (table_t::transaction_t::SELECT == t.type) {
+            selector = table_t::selector(t.group);
+        } else {
+            ASSERT_NE(nullptr, selector);
+            ++numReads[t.sensorIdx];
+
+            // the LEDs of an ADC's sensors are driven by the opto LED driver of its pair
+            EXPECT_TRUE(selector[t.adcIdx ^ 1] & (1 << (t.sensorIdx % 8)));
+        }
+    }
+
+    EXPECT_EQ(NUM_SCAN_GROUPS + Geometry::NUM_SENSORS, table.transactions().size());
+    for (uint8_t i = 0; i < Geometry::NUM_SENSORS; ++i) {
+        EXPECT_EQ(1, numReads[i]);
+    }
+}
+
+} // namespace
+
+TEST(ScanSequencer, geometries) {
+    testScanTableGeometry<PanelGeometry<32>>();
+    testScanTableGeometry<PanelGeometry<48>>();
+    testScanTableGeometry<PanelGeometry<64>>();
+}
@@ -0,0 +1,131 @@
+#include <micro/test/utils.hpp>
+#include <SimdKernels.hpp>
+
+#include <random>
+
+namespace {
+
+// the sizes cover the vectorized loops, their remainders and the truncated windows at the edges
+constexpr uint32_t SIZES[] = { 1, 3, 7, 10, 17, 32, 48, 64 };
+constexpr uint32_t MAX_SIZE = 64;
+
+// the kernels of a backend, every backend available on the host is tested against the scalar reference
+struct backend_t {
+    const char *name;
+    decltype(&simd::scalar::normalize) normalize;
+    decltype(&simd::scalar::accumulate) accumulate;
+    decltype(&simd::scalar::sum) sum;
+    decltype(&simd::scalar::filter3) filter3;
+    decltype(&simd::scalar::thirdSmallest7) thirdSmallest7;
+};
+
+#define SIMD_BACKEND(ns) { #ns, simd::ns::normalize, simd::ns::accumulate, simd::ns::sum, simd::ns::filter3, simd::ns::thirdSmallest7 }
+
+const backend_t BACKENDS[] = {
+    SIMD_BACKEND(scalar),
+#if SIMD_HAS_ARM
+    SIMD_BACKEND(arm),
+#endif
+#if SIMD_BACKEND_SSE
+    SIMD_BACKEND(sse),
+#endif
+};
+
+#undef SIMD_BACKEND
+
+class SimdKernelsTest : public ::testing::Test {
+protected:
+    SimdKernelsTest()
+        : random(1) {
+        std::uniform_int_distribution<uint32_t> byteDist(0, 255);
+        std::uniform_real_distribution<float> floatDist(0.0f, 1.0f);
+
+        for (uint32_t i = 0; i < MAX_SIZE; ++i) {
+            this->bytes[i]   = byteDist(this->random);
+            this->offsets[i] = byteDist(this->random);
+            this->floats[i]  = floatDist(this->random);
+            this->scales[i]  = floatDist(this->random) / 100.0f;
+            this->sums[i]    = byteDist(this->random) * 50;
+        }
+
+        // equal values make the selection of the 3rd smallest value ambiguous
+        this->floats[20] = this->floats[21] = this->floats[23];
+    }
+
+    std::mt19937 random;
+    uint8_t bytes[MAX_SIZE];
+    uint8_t offsets[MAX_SIZE];
+    float floats[MAX_SIZE];
+    float scales[MAX_SIZE];
+    uint16_t sums[MAX_SIZE];
+};
+
+} // namespace
+
+TEST_F(SimdKernelsTest, normalize) {
+    for (const backend_t& backend : BACKENDS) {
+        for (uint32_t size : SIZES) {
+            float expected[MAX_SIZE], result[MAX_SIZE];
+            simd::scalar::normalize(this->bytes, this->offsets, this->scales, expected, size);
+            backend.normalize(this->bytes, this->offsets, this->scales, result, size);
+
+            for (uint32_t i = 0; i < size; ++i) {
+                EXPECT_EQ(expected[i], result[i]) << backend.name << ", size: " << size << ", idx: " << i;
+            }
+        }
+    }
+}
+
+TEST_F(SimdKernelsTest, accumulate) {
+    for (const backend_t& backend : BACKENDS) {
+        for (uint32_t size : SIZES) {
+            uint16_t expected[MAX_SIZE], result[MAX_SIZE];
+            std::copy(&this->sums[0], &this->sums[MAX_SIZE], expected);
+            std::copy(&this->sums[0], &this->sums[MAX_SIZE], result);
+
+            simd::scalar::accumulate(expected, this->bytes, size);
+            backend.accumulate(result, this->bytes, size);
+
+            for (uint32_t i = 0; i < MAX_SIZE; ++i) {
+                EXPECT_EQ(expected[i], result[i]) << backend.name << ", size: " << size << ", idx: " << i;
+            }
+        }
+    }
+}
+
+TEST_F(SimdKernelsTest, sum) {
+    for (const backend_t& backend : BACKENDS) {
+        for (uint32_t size : SIZES) {
+            // only the summation order differs
+            EXPECT_NEAR(simd::scalar::sum(this->floats, size), backend.sum(this->floats, size), 1e-4f) << backend.name << ", size: " << size;
+        }
+    }
+}
+
+TEST_F(SimdKernelsTest, filter3) {
+    for (const backend_t& backend : BACKENDS) {
+        for (uint32_t size : SIZES) {
+            float expected[MAX_SIZE], result[MAX_SIZE];
+            simd::scalar::filter3(this->floats, 0.5f, 2.0f, expected, size);
+            backend.filter3(this->floats, 0.5f, 2.0f, result, size);
+
+            for (uint32_t i = 0; i + 2 < size; ++i) {
+                EXPECT_EQ(expected[i], result[i]) << backend.name << ", size: " << size << ", idx: " << i;
+            }
+        }
+    }
+}
+
+TEST_F(SimdKernelsTest, thirdSmallest7) {
+    for (const backend_t& backend : BACKENDS) {
+        for (uint32_t size : SIZES) {
+            float expected[MAX_SIZE], result[MAX_SIZE];
+            simd::scalar::thirdSmallest7(this->floats, expected, size);
+            backend.thirdSmallest7(this->floats, result, size);
+
+            for (uint32_t i = 0; i < size; ++i) {
+                EXPECT_EQ(expected[i], result[i]) << backend.name << ", size: " << size << ", idx: " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include <micro/test/utils.hpp>
+#include <TripleBuffer.hpp>
+
+#define PRINT_HISTOGRAM false
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+#if PRINT_HISTOGRAM
+#include <iomanip>
+#include <iostream>
+#endif // PRINT_HISTOGRAM
+
+namespace {
+
+struct frame_t {
+    uint32_t seq = 0;
+    std::chrono::steady_clock::time_point timestamp;
+    std::array<uint32_t, 48> payload;
+};
+
+} // namespace
+
+TEST(TripleBuffer, empty) {
+    TripleBuffer<uint32_t> buffer;
+    EXPECT_FALSE(buffer.read());
+    EXPECT_EQ(1, buffer.numStaleReads());
+    EXPECT_EQ(0, buffer.numOverwritten());
+}
+
+TEST(TripleBuffer, newest_value) {
+    TripleBuffer<uint32_t> buffer;
+
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.writeBuffer() = 2;
+    buffer.publish();
+
+    ASSERT_TRUE(buffer.read());
+    EXPECT_EQ(2, buffer.readBuffer());
+    EXPECT_EQ(1, buffer.numOverwritten());
+
+    EXPECT_FALSE(buffer.read());
+    EXPECT_EQ(2, buffer.readBuffer());
+    EXPECT_EQ(1, buffer.numStaleReads());
+
+    buffer.writeBuffer() = 3;
+    buffer.publish();
+
+    ASSERT_TRUE(buffer.read());
+    EXPECT_EQ(3, buffer.readBuffer());
+    EXPECT_EQ(1, buffer.numOverwritten());
+}
+
+TEST(TripleBuffer, read_buffer_is_stable) {
+    TripleBuffer<uint32_t> buffer;
+
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    ASSERT_TRUE(buffer.read());
+    const uint32_t& value = buffer.readBuffer();
+
+    // the producer keeps writing, the value held by the consumer must not change
+    for (uint32_t i = 2; i < 10; ++i) {
+        buffer.writeBuffer() = i;
+        buffer.publish();
+        EXPECT_EQ(1, value);
+    }
+}
+
+TEST(TripleBuffer, stress) {
+    static constexpr uint32_t NUM_FRAMES = 200000;
+    static constexpr uint32_t HISTOGRAM_BUCKET_US = 10;
+
+    TripleBuffer<frame_t> buffer;
+    std::array<uint32_t, 20> latencyHistogram = {};
+    uint32_t numConsumed = 0;
+    uint32_t numTornFrames = 0;
+    uint32_t numOutOfOrder = 0;
+    std::atomic<bool> isProducerFinished(false);
+
+    std::thread producer([&buffer, &isProducerFinished] () {
+        for (uint32_t seq = 1; seq <= NUM_FRAMES; ++seq) {
+            frame_t& frame = buffer.writeBuffer();
+            frame.seq = seq;
+            frame.payload.fill(seq);
+            frame.timestamp = std::chrono::steady_clock::now();
+            buffer.publish();
+        }
+        isProducerFinished = true;
+    });
+
+    std::thread consumer([&] () {
+        uint32_t lastSeq = 0;
+        while (lastSeq < NUM_FRAMES) {
+            // the flag is checked before the read, so that the last published frame is never missed
+            const bool isFinished = isProducerFinished;
+            if (!buffer.read()) {
+                if (isFinished) {
+                    break;
+                }
+                continue;
+            }
+
+            const frame_t& frame = buffer.readBuffer();
+            const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frame.timestamp).count();
+            ++latencyHistogram[std::min<uint32_t>(latency / HISTOGRAM_BUCKET_US, latencyHistogram.size() - 1)];
+
+            if (std::count(frame.payload.begin(), frame.payload.end(), frame.seq) != static_cast<int32_t>(frame.payload.size())) {
+                ++numTornFrames;
+            }
+
+            if (frame.seq <= lastSeq) {
+                ++numOutOfOrder;
+            }
+
+            lastSeq = frame.seq;
+            ++numConsumed;
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    EXPECT_EQ(0, numTornFrames);
+    EXPECT_EQ(0, numOutOfOrder);
+    EXPECT_EQ(NUM_FRAMES, numConsumed + buffer.numOverwritten());
+    EXPECT_EQ(numConsumed, std::accumulate(latencyHistogram.begin(), latencyHistogram.end(), 0u));
+
+#if PRINT_HISTOGRAM
+    std::cout << "consumed: " << numConsumed << ", overwritten: " << buffer.numOverwritten() << ", stale reads: " << buffer.numStaleReads() << std::endl;
+    for (uint32_t i = 0; i < latencyHistogram.size(); ++i) {
+        std::cout << std::setw(4) << i * HISTOGRAM_BUCKET_US << " us: " << latencyHistogram[i] << std::endl;
+    }
+#endif // PRINT_HISTOGRAM
+}
@@ -0,0 +1,93 @@
+#include <micro/test/utils.hpp>
+#include <FileFlash.hpp>
+#include <WhiteLevelStore.hpp>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t PANEL_VERSION = 0x01;
+constexpr uint32_t SECTOR_SIZE  = 16 * 1024;
+
+class WhiteLevelStoreTest : public ::testing::Test {
+protected:
+    WhiteLevelStoreTest()
+        : flash(PATH, SECTOR_SIZE)
+        , store(flash) {
+        std::remove(PATH);
+        for (uint8_t i = 0; i < cfg::NUM_SENSORS; ++i) {
+            this->whiteLevels[i] = 40 + i;
+        }
+    }
+
+    ~WhiteLevelStoreTest() {
+        std::remove(PATH);
+    }
+
+    static constexpr const char *PATH = "utest_whitelevelstore.bin";
+
+    FileFlash flash;
+    WhiteLevelStore<FileFlash> store;
+    Measurements whiteLevels;
+};
+
+constexpr const char *WhiteLevelStoreTest::PATH;
+
+} // namespace
+
+TEST(WhiteLevelStore, crc32) {
+    // standard check value of CRC-32
+    const char *data = "123456789";
+    EXPECT_EQ(0xcbf43926, crc32(reinterpret_cast<const uint8_t*>(data), strlen(data)));
+}
+
+TEST_F(WhiteLevelStoreTest, erased) {
+    Measurements loaded;
+    EXPECT_FALSE(this->store.load(PANEL_VERSION, loaded));
+}
+
+TEST_F(WhiteLevelStoreTest, save_load) {
+    ASSERT_TRUE(this->store.save(PANEL_VERSION, this->whiteLevels));
+    EXPECT_EQ(1, this->flash.numErases);
+
+    Measurements loaded;
+    ASSERT_TRUE(this->store.load(PANEL_VERSION, loaded));
+    EXPECT_EQ(this->whiteLevels, loaded);
+
+    // a new calibration replaces the previous one
+    this->whiteLevels[10] = 100;
+    ASSERT_TRUE(this->store.save(PANEL_VERSION, this->whiteLevels));
+    ASSERT_TRUE(this->store.load(PANEL_VERSION, loaded));
+    EXPECT_EQ(this->whiteLevels, loaded);
+}
+
+TEST_F(WhiteLevelStoreTest, restart) {
+    ASSERT_TRUE(this->store.save(PANEL_VERSION, this->whiteLevels));
+
+    // the content is read back by a new instance, the same way as after a reset
+    FileFlash restartedFlash(PATH, SECTOR_SIZE);
+    WhiteLevelStore<FileFlash> restartedStore(restartedFlash);
+
+    Measurements loaded;
+    ASSERT_TRUE(restartedStore.load(PANEL_VERSION, loaded));
+    EXPECT_EQ(this->whiteLevels, loaded);
+}
+
+TEST_F(WhiteLevelStoreTest, panel_version) {
+    ASSERT_TRUE(this->store.save(PANEL_VERSION, this->whiteLevels));
+
+    Measurements loaded;
+    EXPECT_FALSE(this->store.load(PANEL_VERSION + 1, loaded));
+}
+
+TEST_F(WhiteLevelStoreTest, corrupted) {
+    ASSERT_TRUE(this->store.save(PANEL_VERSION, this->whiteLevels));
+
+    // clears the bits of a single white level, the same way as an interrupted write would
+    const uint8_t corrupted = 0;
+    ASSERT_TRUE(this->flash.write(offsetof(WhiteLevelRecord, whiteLevels) + 5, &corrupted, 1));
+
+    Measurements loaded;
+    EXPECT_FALSE(this->store.load(PANEL_VERSION, loaded));
+}